@@ -0,0 +1,451 @@
+#include "BakedAnimation.h"
+#include "animation/keyed_object.hpp"
+#include "animation/keyed_property.hpp"
+#include "core/field_types/core_bool_type.hpp"
+#include "core/field_types/core_color_type.hpp"
+#include "core/field_types/core_double_type.hpp"
+#include "core/field_types/core_uint_type.hpp"
+#include "generated/core_registry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+static const char bakedMagic[4] = { 'R', 'V', 'B', 'K' };
+static const uint32_t bakedVersion = 2;
+
+template <typename T>
+static void put(std::vector<uint8_t>& out, const T& value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+static const uint8_t* get(const uint8_t* p, const uint8_t* end, T& value) {
+    if (!p || end - p < (ptrdiff_t)sizeof(T)) return nullptr;
+    memcpy(&value, p, sizeof(T));
+    return p + sizeof(T);
+}
+
+static uint32_t floatBits(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+static float bitsFloat(uint32_t bits) {
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+static bool trackType(int propertyKey, BakedTrackType& type) {
+    int field = rive::CoreRegistry::propertyFieldId(propertyKey);
+    if (field == rive::CoreDoubleType::id) type = BakedTrackType::Double;
+    else if (field == rive::CoreColorType::id) type = BakedTrackType::Color;
+    else if (field == rive::CoreUintType::id) type = BakedTrackType::Uint;
+    else if (field == rive::CoreBoolType::id) type = BakedTrackType::Bool;
+    else return false;
+    return true;
+}
+
+static uint32_t readValue(rive::Core* object, int propertyKey, BakedTrackType type) {
+    switch (type) {
+    case BakedTrackType::Double: return floatBits(rive::CoreRegistry::getDouble(object, propertyKey));
+    case BakedTrackType::Color: return (uint32_t)rive::CoreRegistry::getColor(object, propertyKey);
+    case BakedTrackType::Uint: return rive::CoreRegistry::getUint(object, propertyKey);
+    case BakedTrackType::Bool: return rive::CoreRegistry::getBool(object, propertyKey) ? 1 : 0;
+    }
+    return 0;
+}
+
+// Blend two ARGB colors per channel, t in [0, 1]
+static uint32_t lerpColor(uint32_t a, uint32_t b, float t) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        float from = (float)((a >> shift) & 0xff);
+        float to = (float)((b >> shift) & 0xff);
+        result |= (uint32_t)(from + (to - from) * t + 0.5f) << shift;
+    }
+    return result;
+}
+
+// Writes a single value the slow way, for constant and stepped tracks
+static void writeValue(rive::Core* object, int propertyKey, BakedTrackType type, uint32_t value, float mix) {
+    switch (type) {
+    case BakedTrackType::Double: {
+        float v = bitsFloat(value);
+        if (mix < 1.0f) {
+            float current = rive::CoreRegistry::getDouble(object, propertyKey);
+            v = current + (v - current) * mix;
+        }
+        rive::CoreRegistry::setDouble(object, propertyKey, v);
+        break;
+    }
+    case BakedTrackType::Color:
+        if (mix < 1.0f) value = lerpColor((uint32_t)rive::CoreRegistry::getColor(object, propertyKey), value, mix);
+        rive::CoreRegistry::setColor(object, propertyKey, (int)value);
+        break;
+    case BakedTrackType::Uint:
+        rive::CoreRegistry::setUint(object, propertyKey, value);
+        break;
+    case BakedTrackType::Bool:
+        rive::CoreRegistry::setBool(object, propertyKey, value != 0);
+        break;
+    }
+}
+
+bool BakedAnimation::bake(rive::LinearAnimation* animation, rive::Artboard* artboard, float sampleRate) {
+    if (!animation || !artboard) return false;
+
+    _startSeconds = animation->startSeconds();
+    _endSeconds = std::max(_startSeconds, animation->endSeconds());
+    _sampleRate = sampleRate > 0 ? sampleRate : (animation->fps() > 0 ? (float)animation->fps() : 60.0f);
+    _speed = animation->speed();
+    _loop = animation->loop();
+    // One sample per frame including both ends, the last one clamped to the end
+    _frameCount = (uint32_t)std::ceil((_endSeconds - _startSeconds) * _sampleRate - 1e-3f) + 1;
+    for (auto& group : _groups) group = Tracks();
+    _lerpedValues.clear();
+
+    struct Source {
+        rive::Core* object;
+        uint32_t objectId;
+        uint16_t coreType;
+        rive::KeyedProperty* property;
+        BakedTrackType type;
+        std::vector<uint32_t> samples;
+    };
+    std::vector<Source> sources;
+    for (size_t i = 0; i < animation->numKeyedObjects(); i++) {
+        rive::KeyedObject* keyed = animation->getObject(i);
+        rive::Core* object = artboard->resolve(keyed->objectId());
+        if (!object) continue;
+        for (size_t j = 0; j < keyed->numKeyedProperties(); j++) {
+            rive::KeyedProperty* property = keyed->getProperty(j);
+            BakedTrackType type;
+            if (!trackType(property->propertyKey(), type)) continue;
+            sources.push_back({ object, keyed->objectId(), object->coreType(), property, type, {} });
+            sources.back().samples.resize(_frameCount);
+        }
+    }
+    if (sources.empty()) return false;
+
+    // Each property is applied on its own, so the samples don't depend on the
+    // order the animation would apply them in
+    for (uint32_t frame = 0; frame < _frameCount; frame++) {
+        float time = std::min(_startSeconds + frame / _sampleRate, _endSeconds);
+        for (auto& source : sources) {
+            int key = (int)source.property->propertyKey();
+            source.property->apply(source.object, time, 1.0f);
+            source.samples[frame] = readValue(source.object, key, source.type);
+        }
+    }
+
+    // Hold keyframes make a value jump between two samples, and blending
+    // across the jump would turn it into a ramp. Where two samples differ,
+    // values inside the interval that all match one end or the other mean
+    // the value jumped; an interpolated value passes between them.
+    auto jumps = [&](Source& source) {
+        int key = (int)source.property->propertyKey();
+        for (uint32_t frame = 0; frame + 1 < _frameCount; frame++) {
+            uint32_t from = source.samples[frame];
+            uint32_t to = source.samples[frame + 1];
+            if (from == to) continue;
+            float start = _startSeconds + frame / _sampleRate;
+            float end = std::min(_startSeconds + (frame + 1) / _sampleRate, _endSeconds);
+            bool step = true;
+            for (float t : { 0.25f, 0.5f, 0.75f }) {
+                source.property->apply(source.object, start + (end - start) * t, 1.0f);
+                uint32_t value = readValue(source.object, key, source.type);
+                if (value != from && value != to) {
+                    step = false;
+                    break;
+                }
+            }
+            if (step) return true;
+        }
+        return false;
+    };
+
+    // Sort the tracks into groups, then lay the groups out frame by frame
+    std::vector<const Source*> members[GroupCount];
+    for (auto& source : sources) {
+        bool constant = std::all_of(source.samples.begin(), source.samples.end(),
+            [&](uint32_t value) { return value == source.samples[0]; });
+        bool blended = source.type == BakedTrackType::Double || source.type == BakedTrackType::Color;
+        Group group = constant ? Constant :
+            blended && jumps(source) ? Stepped :
+            source.type == BakedTrackType::Double ? Lerped :
+            source.type == BakedTrackType::Color ? Color : Stepped;
+        members[group].push_back(&source);
+    }
+    for (int g = 0; g < GroupCount; g++) {
+        Tracks& tracks = _groups[g];
+        for (const Source* source : members[g]) {
+            tracks.objectIds.push_back(source->objectId);
+            tracks.coreTypes.push_back(source->coreType);
+            tracks.propertyKeys.push_back((uint16_t)source->property->propertyKey());
+            tracks.types.push_back(source->type);
+        }
+        uint32_t frames = g == Constant ? 1 : _frameCount;
+        size_t count = members[g].size();
+        if (g == Lerped) {
+            _lerpedValues.resize(frames * count);
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                for (size_t track = 0; track < count; track++) {
+                    _lerpedValues[frame * count + track] = bitsFloat(members[g][track]->samples[frame]);
+                }
+            }
+        }
+        else {
+            tracks.values.resize(frames * count);
+            for (uint32_t frame = 0; frame < frames; frame++) {
+                for (size_t track = 0; track < count; track++) {
+                    tracks.values[frame * count + track] = members[g][track]->samples[frame];
+                }
+            }
+        }
+    }
+    return true;
+}
+
+size_t BakedAnimation::trackCount() const {
+    size_t count = 0;
+    for (const auto& group : _groups) count += group.size();
+    return count;
+}
+
+size_t BakedAnimation::valueBytes() const {
+    size_t bytes = _lerpedValues.size() * sizeof(float);
+    for (const auto& group : _groups) bytes += group.values.size() * sizeof(uint32_t);
+    return bytes;
+}
+
+bool BakedAnimation::save(const std::string& path) const {
+    std::vector<uint8_t> out;
+    out.insert(out.end(), bakedMagic, bakedMagic + 4);
+    put(out, bakedVersion);
+    put(out, _startSeconds);
+    put(out, _endSeconds);
+    put(out, _sampleRate);
+    put(out, _speed);
+    put(out, (uint8_t)_loop);
+    put(out, _frameCount);
+    for (int g = 0; g < GroupCount; g++) {
+        const Tracks& tracks = _groups[g];
+        put(out, (uint32_t)tracks.size());
+        for (size_t i = 0; i < tracks.size(); i++) {
+            put(out, tracks.objectIds[i]);
+            put(out, tracks.coreTypes[i]);
+            put(out, tracks.propertyKeys[i]);
+            put(out, (uint8_t)tracks.types[i]);
+        }
+        if (g == Lerped) {
+            for (float value : _lerpedValues) put(out, floatBits(value));
+        }
+        else {
+            for (uint32_t value : tracks.values) put(out, value);
+        }
+    }
+
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    bool written = fwrite(out.data(), 1, out.size(), fp) == out.size();
+    return fclose(fp) == 0 && written;
+}
+
+bool BakedAnimation::load(const std::string& path) {
+    FILE* fp = fopen(path.c_str(), "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    std::vector<uint8_t> data(size > 0 ? (size_t)size : 0);
+    bool read = fread(data.data(), 1, data.size(), fp) == data.size();
+    fclose(fp);
+    if (!read || data.size() < 4 || memcmp(data.data(), bakedMagic, 4) != 0) return false;
+
+    const uint8_t* end = data.data() + data.size();
+    const uint8_t* p = data.data() + 4;
+    uint32_t version = 0;
+    uint8_t loop = 0;
+    p = get(p, end, version);
+    if (!p || version != bakedVersion) return false;
+    p = get(p, end, _startSeconds);
+    p = get(p, end, _endSeconds);
+    p = get(p, end, _sampleRate);
+    p = get(p, end, _speed);
+    p = get(p, end, loop);
+    p = get(p, end, _frameCount);
+    if (!p || _frameCount == 0 || _sampleRate <= 0 || loop > (uint8_t)rive::Loop::pingPong) return false;
+    _loop = (rive::Loop)loop;
+
+    for (int g = 0; g < GroupCount; g++) {
+        Tracks& tracks = _groups[g];
+        tracks = Tracks();
+        uint32_t count = 0;
+        p = get(p, end, count);
+        if (!p) return false;
+        for (uint32_t i = 0; i < count && p; i++) {
+            uint32_t objectId;
+            uint16_t coreType;
+            uint16_t propertyKey;
+            uint8_t type;
+            p = get(p, end, objectId);
+            p = get(p, end, coreType);
+            p = get(p, end, propertyKey);
+            p = get(p, end, type);
+            if (!p || type > (uint8_t)BakedTrackType::Bool) return false;
+            tracks.objectIds.push_back(objectId);
+            tracks.coreTypes.push_back(coreType);
+            tracks.propertyKeys.push_back(propertyKey);
+            tracks.types.push_back((BakedTrackType)type);
+        }
+
+        size_t values = (size_t)count * (g == Constant ? 1 : _frameCount);
+        if (!p || (size_t)(end - p) < values * sizeof(uint32_t)) return false;
+        if (g == Lerped) {
+            _lerpedValues.resize(values);
+            memcpy(_lerpedValues.data(), p, values * sizeof(float));
+        }
+        else {
+            tracks.values.resize(values);
+            memcpy(tracks.values.data(), p, values * sizeof(uint32_t));
+        }
+        p += values * sizeof(uint32_t);
+    }
+    return true;
+}
+
+BakedAnimationInstance::BakedAnimationInstance(std::shared_ptr<const BakedAnimation> animation, rive::Artboard* artboard) :
+    _animation(std::move(animation)) {
+    for (int g = 0; g < BakedAnimation::GroupCount; g++) {
+        const auto& tracks = _animation->_groups[g];
+        _targets[g].resize(tracks.size());
+        for (size_t i = 0; i < tracks.size(); i++) {
+            // Properties are written through a cast to the type that owns
+            // them, an object of another type, as in a different file, is
+            // left alone
+            rive::Core* object = artboard->resolve(tracks.objectIds[i]);
+            if (object && object->coreType() != tracks.coreTypes[i]) object = nullptr;
+            _targets[g][i] = object;
+            if (!_targets[g][i]) _unresolved++;
+        }
+    }
+    _lerped.resize(_animation->_groups[BakedAnimation::Lerped].size());
+    _colors.resize(_animation->_groups[BakedAnimation::Color].size());
+    _time = _animation->startSeconds();
+}
+
+void BakedAnimationInstance::time(float seconds) {
+    _time = seconds;
+    _direction = 1;
+}
+
+bool BakedAnimationInstance::advance(float seconds) {
+    const BakedAnimation& animation = *_animation;
+    float start = animation.startSeconds();
+    float end = animation.endSeconds();
+    float range = end - start;
+    _time += seconds * animation.speed() * _direction;
+    if (range <= 0) {
+        _time = start;
+        return false;
+    }
+
+    switch (animation.loop()) {
+    case rive::Loop::oneShot:
+        if (_time > end || _time < start) {
+            _time = std::min(std::max(_time, start), end);
+            return false;
+        }
+        break;
+    case rive::Loop::loop:
+        if (_time >= end || _time < start) {
+            _time = start + std::fmod(_time - start, range);
+            if (_time < start) _time += range;
+        }
+        break;
+    case rive::Loop::pingPong:
+        if (_time > end || _time < start) {
+            // Every crossing of an end reflects time and reverses direction
+            float offset = _time - start;
+            float crossings = std::floor(offset / range);
+            float phase = offset - crossings * range;
+            bool reflected = std::fmod(std::fabs(crossings), 2.0f) == 1.0f;
+            _time = reflected ? end - phase : start + phase;
+            if (reflected) _direction = -_direction;
+        }
+        break;
+    }
+    return true;
+}
+
+void BakedAnimationInstance::apply(float mix) {
+    const BakedAnimation& animation = *_animation;
+    if (animation._frameCount == 0 || mix <= 0) return;
+
+    // Position between samples, clamped like keyframes clamp outside the range
+    float last = (float)(animation._frameCount - 1);
+    float position = std::min(std::max((_time - animation._startSeconds) * animation._sampleRate, 0.0f), last);
+    uint32_t frame = (uint32_t)position;
+    uint32_t next = std::min(frame + 1, animation._frameCount - 1);
+    float t = position - frame;
+    // Samples land on keyframes; don't let rounding step a held value early or late
+    uint32_t held = (uint32_t)std::min(position + 1e-3f, last);
+
+    // Lerped doubles: blend two rows into contiguous scratch, then write them
+    {
+        const auto& tracks = animation._groups[BakedAnimation::Lerped];
+        const auto& targets = _targets[BakedAnimation::Lerped];
+        size_t count = tracks.size();
+        const float* from = animation._lerpedValues.data() + frame * count;
+        const float* to = animation._lerpedValues.data() + next * count;
+        float* values = _lerped.data();
+        for (size_t i = 0; i < count; i++) values[i] = from[i] + (to[i] - from[i]) * t;
+        if (mix < 1.0f) {
+            for (size_t i = 0; i < count; i++) {
+                if (!targets[i]) continue;
+                float current = rive::CoreRegistry::getDouble(targets[i], tracks.propertyKeys[i]);
+                values[i] = current + (values[i] - current) * mix;
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            if (targets[i]) rive::CoreRegistry::setDouble(targets[i], tracks.propertyKeys[i], values[i]);
+        }
+    }
+
+    {
+        const auto& tracks = animation._groups[BakedAnimation::Color];
+        const auto& targets = _targets[BakedAnimation::Color];
+        size_t count = tracks.size();
+        const uint32_t* from = tracks.values.data() + frame * count;
+        const uint32_t* to = tracks.values.data() + next * count;
+        for (size_t i = 0; i < count; i++) _colors[i] = lerpColor(from[i], to[i], t);
+        for (size_t i = 0; i < count; i++) {
+            if (!targets[i]) continue;
+            uint32_t value = _colors[i];
+            if (mix < 1.0f) value = lerpColor((uint32_t)rive::CoreRegistry::getColor(targets[i], tracks.propertyKeys[i]), value, mix);
+            rive::CoreRegistry::setColor(targets[i], tracks.propertyKeys[i], (int)value);
+        }
+    }
+
+    {
+        const auto& tracks = animation._groups[BakedAnimation::Stepped];
+        const auto& targets = _targets[BakedAnimation::Stepped];
+        size_t count = tracks.size();
+        const uint32_t* values = tracks.values.data() + held * count;
+        for (size_t i = 0; i < count; i++) {
+            if (targets[i]) writeValue(targets[i], tracks.propertyKeys[i], tracks.types[i], values[i], mix);
+        }
+    }
+
+    {
+        const auto& tracks = animation._groups[BakedAnimation::Constant];
+        const auto& targets = _targets[BakedAnimation::Constant];
+        for (size_t i = 0; i < tracks.size(); i++) {
+            if (targets[i]) writeValue(targets[i], tracks.propertyKeys[i], tracks.types[i], tracks.values[i], mix);
+        }
+    }
+}
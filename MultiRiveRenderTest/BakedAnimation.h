@@ -0,0 +1,159 @@
+#pragma once
+
+/**
+ * @file BakedAnimation.h
+ * Linear animations pre-evaluated into flat tracks, and an applier that
+ * writes them into artboards without walking keyed objects, keyframes and
+ * interpolators.
+ *
+ * Every animated property is sampled at a fixed rate, the animation's fps by
+ * default, so cubic interpolation is baked in. Tracks are kept as structure
+ * of arrays, one array per kind, with the values of all tracks for a frame
+ * next to each other. Applying a frame is a linear blend of two rows
+ * followed by one property write per track, and every instance of the same
+ * animation reads the same rows. Doubles and colors that jump from a hold
+ * keyframe aren't blended: the whole track holds each sample until the next,
+ * so its jumps land on the first sample at or after the keyframe.
+ *
+ * File layout, in the byte order of the machine that baked it:
+ *   header  "RVBK", uint32 version, float startSeconds, float endSeconds,
+ *           float sampleRate, float speed, uint8 loop, uint32 frameCount
+ *   groups  Lerped, Color, Stepped and Constant, in that order, each
+ *           uint32 trackCount, (uint32 objectId, uint16 coreType, uint16 propertyKey, uint8 type) * trackCount,
+ *           then uint32 values[trackCount * frames], frame by frame. Constant
+ *           tracks have one frame, the others frameCount. Doubles are stored
+ *           as float bits.
+ */
+
+#include "artboard.hpp"
+#include "animation/linear_animation.hpp"
+#include "animation/loop.hpp"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+enum class BakedTrackType : uint8_t {
+    Double = 0,
+    Color,
+    Uint,
+    Bool
+};
+
+/**
+ * @brief The sampled values of one linear animation. Immutable once baked or
+ * loaded, share it between any number of BakedAnimationInstances.
+ */
+class BakedAnimation {
+public:
+    /**
+     * Sample an animation. The properties are evaluated on the artboard,
+     * which is left posed at the animation's end; apply an animation again
+     * before drawing it.
+     * @param sampleRate Samples per second, 0 for the animation's fps
+     * @return false if the animation has nothing to bake
+     */
+    bool bake(rive::LinearAnimation* animation, rive::Artboard* artboard, float sampleRate = 0);
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    float startSeconds() const { return _startSeconds; }
+    float endSeconds() const { return _endSeconds; }
+    float durationSeconds() const { return _endSeconds - _startSeconds; }
+    float sampleRate() const { return _sampleRate; }
+    float speed() const { return _speed; }
+    rive::Loop loop() const { return _loop; }
+    uint32_t frameCount() const { return _frameCount; }
+
+    size_t trackCount() const;
+
+    /**
+     * @return The memory taken by the sampled values
+     */
+    size_t valueBytes() const;
+
+protected:
+    friend class BakedAnimationInstance;
+
+    enum Group {
+        // Doubles, blended between samples
+        Lerped = 0,
+        // Colors, blended per channel
+        Color,
+        // Ids, bools and anything with hold keyframes, which hold until the
+        // next sample
+        Stepped,
+        // Properties that are keyed but never change
+        Constant,
+        GroupCount
+    };
+
+    struct Tracks {
+        std::vector<uint32_t> objectIds;
+        // The type each object had when baked
+        std::vector<uint16_t> coreTypes;
+        std::vector<uint16_t> propertyKeys;
+        std::vector<BakedTrackType> types;
+        // Frame major, values[frame * size() + track]
+        std::vector<uint32_t> values;
+
+        size_t size() const { return objectIds.size(); }
+    };
+
+    float _startSeconds = 0;
+    float _endSeconds = 0;
+    float _sampleRate = 60;
+    float _speed = 1;
+    rive::Loop _loop = rive::Loop::oneShot;
+    uint32_t _frameCount = 0;
+    // Lerped values are floats and kept apart so blending them is a plain loop
+    std::vector<float> _lerpedValues;
+    Tracks _groups[GroupCount];
+};
+
+/**
+ * @brief Plays a BakedAnimation on one artboard. A lighter replacement for
+ * rive::LinearAnimationInstance with the same time and loop behaviour.
+ */
+class BakedAnimationInstance {
+public:
+    /**
+     * Resolve the tracks' objects on an artboard. Objects it doesn't have,
+     * or whose type differs from the baked one, are skipped when applying.
+     */
+    BakedAnimationInstance(std::shared_ptr<const BakedAnimation> animation, rive::Artboard* artboard);
+
+    /**
+     * Move time forward, looping or stopping as the animation says
+     * @return false once a one shot animation has reached its end
+     */
+    bool advance(float seconds);
+
+    float time() const { return _time; }
+    void time(float seconds);
+
+    /**
+     * Write the values at the current time into the artboard
+     * @param mix How much of the animation to blend over the current values
+     */
+    void apply(float mix = 1.0f);
+
+    const BakedAnimation* animation() const { return _animation.get(); }
+    const std::shared_ptr<const BakedAnimation>& sharedAnimation() const { return _animation; }
+
+    /**
+     * @return The number of tracks whose object the artboard doesn't have,
+     * or has with another type
+     */
+    size_t unresolved() const { return _unresolved; }
+
+protected:
+    std::shared_ptr<const BakedAnimation> _animation;
+    std::vector<rive::Core*> _targets[BakedAnimation::GroupCount];
+    std::vector<float> _lerped;
+    std::vector<uint32_t> _colors;
+    size_t _unresolved = 0;
+    float _time = 0;
+    int _direction = 1;
+};
@@ -0,0 +1,415 @@
+#include "CaptureFile.h"
+#include <cstring>
+
+static const char captureMagic[4] = { 'R', 'V', 'C', 'P' };
+static const uint32_t captureVersion = 1;
+static const size_t frameCountOffset = 16;
+
+template <typename T>
+static void put( std::vector<uint8_t>& out, const T& value ) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>( &value );
+	out.insert( out.end(), bytes, bytes + sizeof( T ) );
+}
+
+template <typename T>
+static const uint8_t* get( const uint8_t* p, const uint8_t* end, T& value ) {
+	if ( !p || end - p < (ptrdiff_t)sizeof( T ) ) return nullptr;
+	memcpy( &value, p, sizeof( T ) );
+	return p + sizeof( T );
+}
+
+CaptureWriter::~CaptureWriter() {
+	close();
+}
+
+bool CaptureWriter::open( const std::string& path, uint32_t width, uint32_t height ) {
+	m_File = fopen( path.c_str(), "wb" );
+	if ( !m_File ) return false;
+	m_FrameCount = 0;
+	m_Paths.clear();
+	m_Paints.clear();
+
+	m_Out.clear();
+	m_Out.insert( m_Out.end(), captureMagic, captureMagic + 4 );
+	put( m_Out, captureVersion );
+	put( m_Out, width );
+	put( m_Out, height );
+	put( m_Out, m_FrameCount );
+	return fwrite( m_Out.data(), 1, m_Out.size(), m_File ) == m_Out.size();
+}
+
+void CaptureWriter::writePath( TvgRenderPath* path, uint32_t id ) {
+	path->build();
+	const tvg::PathCommand* cmds = path->commands.data();
+	const tvg::Point* pts = path->points.data();
+	uint32_t cmdCnt = (uint32_t)path->commands.size();
+	uint32_t ptsCnt = (uint32_t)path->points.size();
+
+	m_Out.push_back( (uint8_t)CaptureRecord::PathDef );
+	put( m_Out, id );
+	m_Out.push_back( (uint8_t)path->tvgFillRule );
+	put( m_Out, cmdCnt );
+	put( m_Out, ptsCnt );
+	for ( uint32_t i = 0; i < cmdCnt; i++ ) m_Out.push_back( (uint8_t)cmds[i] );
+	for ( uint32_t i = 0; i < ptsCnt; i++ ) {
+		put( m_Out, pts[i].x );
+		put( m_Out, pts[i].y );
+	}
+}
+
+void CaptureWriter::paintBytes( TvgRenderPaint* renderPaint, std::vector<uint8_t>& out ) {
+	TvgPaint* paint = renderPaint->paint();
+	out.clear();
+	out.push_back( (uint8_t)paint->style );
+	out.insert( out.end(), paint->color, paint->color + 4 );
+	put( out, paint->thickness );
+	out.push_back( (uint8_t)paint->join );
+	out.push_back( (uint8_t)paint->cap );
+	out.push_back( (uint8_t)paint->blendMode );
+
+	const tvg::Fill* fill = paint->isGradient ? paint->gradientFill : nullptr;
+	float params[4] = { 0, 0, 0, 0 };
+	uint8_t type = 0;
+	if ( auto linear = dynamic_cast<const tvg::LinearGradient*>( fill ) ) {
+		type = 1;
+		linear->linear( &params[0], &params[1], &params[2], &params[3] );
+	}
+	else if ( auto radial = dynamic_cast<const tvg::RadialGradient*>( fill ) ) {
+		// Stored as a centre and a point on the circle, as rive describes it
+		type = 2;
+		radial->radial( &params[0], &params[1], &params[2] );
+		params[2] += params[0];
+		params[3] = params[1];
+	}
+	out.push_back( type );
+	if ( type != 0 ) {
+		for ( float v : params ) put( out, v );
+		const tvg::Fill::ColorStop* stops = nullptr;
+		uint32_t stopCount = fill->colorStops( &stops );
+		put( out, stopCount );
+		for ( uint32_t i = 0; i < stopCount; i++ ) {
+			put( out, stops[i].offset );
+			out.push_back( stops[i].r );
+			out.push_back( stops[i].g );
+			out.push_back( stops[i].b );
+			out.push_back( stops[i].a );
+		}
+	}
+}
+
+bool CaptureWriter::writeFrame( const CommandBuffer& buffer, float dt ) {
+	if ( !m_File ) return false;
+	m_Out.clear();
+
+	// Define whatever is new or changed, then the commands that use them
+	std::vector<uint32_t> pathIds( buffer.paths.size() );
+	for ( size_t i = 0; i < buffer.paths.size(); i++ ) {
+		auto path = static_cast<TvgRenderPath*>( buffer.paths[i] );
+		path->build();
+		auto found = m_Paths.find( path );
+		if ( found == m_Paths.end() ) {
+			uint32_t id = (uint32_t)m_Paths.size();
+			m_Paths[path] = { id, path->version };
+			writePath( path, id );
+			pathIds[i] = id;
+		}
+		else {
+			if ( found->second.version != path->version ) {
+				found->second.version = path->version;
+				writePath( path, found->second.id );
+			}
+			pathIds[i] = found->second.id;
+		}
+	}
+
+	std::vector<uint32_t> paintIds( buffer.paints.size() );
+	for ( size_t i = 0; i < buffer.paints.size(); i++ ) {
+		auto paint = static_cast<TvgRenderPaint*>( buffer.paints[i] );
+		paintBytes( paint, m_Scratch );
+		auto found = m_Paints.find( paint );
+		if ( found == m_Paints.end() ) {
+			found = m_Paints.emplace( paint, PaintState{ (uint32_t)m_Paints.size(), {} } ).first;
+		}
+		else if ( found->second.bytes == m_Scratch ) {
+			paintIds[i] = found->second.id;
+			continue;
+		}
+		found->second.bytes = m_Scratch;
+		m_Out.push_back( (uint8_t)CaptureRecord::PaintDef );
+		put( m_Out, found->second.id );
+		m_Out.insert( m_Out.end(), m_Scratch.begin(), m_Scratch.end() );
+		paintIds[i] = found->second.id;
+	}
+
+	for ( const auto& cmd : buffer.commands ) {
+		switch ( cmd.op ) {
+			case RenderOp::Save:
+				m_Out.push_back( (uint8_t)CaptureRecord::Save );
+				break;
+			case RenderOp::Restore:
+				m_Out.push_back( (uint8_t)CaptureRecord::Restore );
+				break;
+			case RenderOp::Transform: {
+				m_Out.push_back( (uint8_t)CaptureRecord::Transform );
+				const auto& m = buffer.transforms[cmd.a];
+				for ( int i = 0; i < 6; i++ ) put( m_Out, m[i] );
+				break;
+			}
+			case RenderOp::ClipPath:
+				m_Out.push_back( (uint8_t)CaptureRecord::ClipPath );
+				put( m_Out, pathIds[cmd.a] );
+				break;
+			case RenderOp::DrawPath:
+				m_Out.push_back( (uint8_t)CaptureRecord::DrawPath );
+				put( m_Out, pathIds[cmd.a] );
+				put( m_Out, paintIds[cmd.b] );
+				break;
+		}
+	}
+	m_Out.push_back( (uint8_t)CaptureRecord::End );
+
+	uint32_t length = (uint32_t)m_Out.size();
+	if ( fwrite( &dt, sizeof( dt ), 1, m_File ) != 1 ) return false;
+	if ( fwrite( &length, sizeof( length ), 1, m_File ) != 1 ) return false;
+	if ( fwrite( m_Out.data(), 1, m_Out.size(), m_File ) != m_Out.size() ) return false;
+	m_FrameCount++;
+	return true;
+}
+
+bool CaptureWriter::close() {
+	if ( !m_File ) return false;
+	bool ok = fseek( m_File, frameCountOffset, SEEK_SET ) == 0 &&
+		fwrite( &m_FrameCount, sizeof( m_FrameCount ), 1, m_File ) == 1;
+	ok = fclose( m_File ) == 0 && ok;
+	m_File = nullptr;
+	return ok;
+}
+
+bool CaptureReader::load( const std::string& path ) {
+	FILE* fp = fopen( path.c_str(), "rb" );
+	if ( !fp ) return false;
+	fseek( fp, 0, SEEK_END );
+	size_t size = ftell( fp );
+	fseek( fp, 0, SEEK_SET );
+	m_Data.resize( size );
+	bool read = fread( m_Data.data(), 1, size, fp ) == size;
+	fclose( fp );
+	if ( !read || size < 20 || memcmp( m_Data.data(), captureMagic, 4 ) != 0 ) return false;
+
+	uint32_t version, frameCount;
+	const uint8_t* end = m_Data.data() + size;
+	const uint8_t* p = m_Data.data() + 4;
+	p = get( p, end, version );
+	p = get( p, end, m_Width );
+	p = get( p, end, m_Height );
+	p = get( p, end, frameCount );
+	if ( !p || version != captureVersion ) return false;
+
+	// Index the frames so replay doesn't need to parse ahead
+	m_Frames.clear();
+	size_t offset = p - m_Data.data();
+	while ( m_Frames.size() < frameCount && offset + 8 <= size ) {
+		Frame frame;
+		uint32_t length;
+		get( m_Data.data() + offset, end, frame.dt );
+		get( m_Data.data() + offset + 4, end, length );
+		frame.offset = offset + 8;
+		frame.length = length;
+		if ( length > size - frame.offset ) break;
+		m_Frames.push_back( frame );
+		offset = frame.offset + length;
+	}
+	rewind();
+	return m_Frames.size() == frameCount;
+}
+
+void CaptureReader::rewind() {
+	m_Next = 0;
+	m_Failed = false;
+	m_Paths.clear();
+	m_Paints.clear();
+}
+
+const uint8_t* CaptureReader::readPathDef( const uint8_t* p, const uint8_t* end ) {
+	uint32_t id, cmdCnt, ptsCnt;
+	uint8_t fillRule;
+	p = get( p, end, id );
+	p = get( p, end, fillRule );
+	p = get( p, end, cmdCnt );
+	p = get( p, end, ptsCnt );
+	if ( !p || cmdCnt > (size_t)( end - p ) || ptsCnt > ( (size_t)( end - p ) - cmdCnt ) / 8 ) return nullptr;
+	const uint8_t* cmds = p;
+	const uint8_t* pts = p + cmdCnt;
+	const uint8_t* ptsEnd = pts + (size_t)ptsCnt * 8;
+
+	auto& path = m_Paths[id];
+	if ( !path ) path.reset( new TvgRenderPath() );
+	path->reset();
+	path->fillRule( (tvg::FillRule)fillRule == tvg::FillRule::EvenOdd ? rive::FillRule::evenOdd : rive::FillRule::nonZero );
+
+	float v[6];
+	for ( uint32_t i = 0; i < cmdCnt; i++ ) {
+		switch ( (tvg::PathCommand)cmds[i] ) {
+			case tvg::PathCommand::MoveTo:
+				if ( ptsEnd - pts < 8 ) return nullptr;
+				memcpy( v, pts, 8 );
+				pts += 8;
+				path->moveTo( v[0], v[1] );
+				break;
+			case tvg::PathCommand::LineTo:
+				if ( ptsEnd - pts < 8 ) return nullptr;
+				memcpy( v, pts, 8 );
+				pts += 8;
+				path->lineTo( v[0], v[1] );
+				break;
+			case tvg::PathCommand::CubicTo:
+				if ( ptsEnd - pts < 24 ) return nullptr;
+				memcpy( v, pts, 24 );
+				pts += 24;
+				path->cubicTo( v[0], v[1], v[2], v[3], v[4], v[5] );
+				break;
+			case tvg::PathCommand::Close:
+				path->close();
+				break;
+		}
+	}
+	path->build();
+	return ptsEnd;
+}
+
+static rive::StrokeJoin toRiveJoin( tvg::StrokeJoin join ) {
+	switch ( join ) {
+		case tvg::StrokeJoin::Round: return rive::StrokeJoin::round;
+		case tvg::StrokeJoin::Miter: return rive::StrokeJoin::miter;
+		default: return rive::StrokeJoin::bevel;
+	}
+}
+
+static rive::StrokeCap toRiveCap( tvg::StrokeCap cap ) {
+	switch ( cap ) {
+		case tvg::StrokeCap::Round: return rive::StrokeCap::round;
+		case tvg::StrokeCap::Square: return rive::StrokeCap::square;
+		default: return rive::StrokeCap::butt;
+	}
+}
+
+static unsigned int toArgb( const uint8_t* rgba ) {
+	return (unsigned int)rgba[3] << 24 | (unsigned int)rgba[0] << 16 | (unsigned int)rgba[1] << 8 | rgba[2];
+}
+
+const uint8_t* CaptureReader::readPaintDef( const uint8_t* p, const uint8_t* end ) {
+	uint32_t id;
+	uint8_t style, join, cap, blend, type;
+	uint8_t rgba[4];
+	float thickness;
+	p = get( p, end, id );
+	p = get( p, end, style );
+	p = get( p, end, rgba );
+	p = get( p, end, thickness );
+	p = get( p, end, join );
+	p = get( p, end, cap );
+	p = get( p, end, blend );
+	p = get( p, end, type );
+	if ( !p ) return nullptr;
+
+	// Paints are rebuilt from scratch, they can't switch back from a gradient
+	auto& paint = m_Paints[id];
+	paint.reset( new TvgRenderPaint() );
+	paint->style( (rive::RenderPaintStyle)style );
+	paint->thickness( thickness );
+	paint->join( toRiveJoin( (tvg::StrokeJoin)join ) );
+	paint->cap( toRiveCap( (tvg::StrokeCap)cap ) );
+	paint->blendMode( (rive::BlendMode)blend );
+
+	if ( type == 0 ) {
+		paint->color( toArgb( rgba ) );
+		return p;
+	}
+
+	float params[4];
+	uint32_t stopCount;
+	for ( float& v : params ) p = get( p, end, v );
+	p = get( p, end, stopCount );
+	// Each stop is an offset and a color
+	if ( !p || stopCount > (size_t)( end - p ) / 8 ) return nullptr;
+	if ( type == 1 ) paint->linearGradient( params[0], params[1], params[2], params[3] );
+	else paint->radialGradient( params[0], params[1], params[2], params[3] );
+	for ( uint32_t i = 0; i < stopCount; i++ ) {
+		float offset;
+		p = get( p, end, offset );
+		p = get( p, end, rgba );
+		paint->addStop( toArgb( rgba ), offset );
+	}
+	paint->completeGradient();
+	return p;
+}
+
+bool CaptureReader::replayNext( rive::Renderer* renderer ) {
+	if ( m_Failed || m_Next >= m_Frames.size() ) return false;
+	const Frame& frame = m_Frames[m_Next++];
+	const uint8_t* p = m_Data.data() + frame.offset;
+	const uint8_t* end = p + frame.length;
+
+	// Records are read up to the frame's end, a truncated or corrupt frame
+	// stops the replay instead of reading past it
+	while ( p ) {
+		uint8_t record;
+		p = get( p, end, record );
+		if ( !p ) break;
+		switch ( (CaptureRecord)record ) {
+			case CaptureRecord::End:
+				return true;
+			case CaptureRecord::PathDef:
+				p = readPathDef( p, end );
+				break;
+			case CaptureRecord::PaintDef:
+				p = readPaintDef( p, end );
+				break;
+			case CaptureRecord::Save:
+				renderer->save();
+				break;
+			case CaptureRecord::Restore:
+				renderer->restore();
+				break;
+			case CaptureRecord::Transform: {
+				rive::Mat2D m;
+				for ( int i = 0; i < 6; i++ ) p = get( p, end, m[i] );
+				if ( p ) renderer->transform( m );
+				break;
+			}
+			case CaptureRecord::ClipPath: {
+				uint32_t id;
+				p = get( p, end, id );
+				TvgRenderPath* path = p ? findPath( id ) : nullptr;
+				if ( !path ) p = nullptr;
+				else renderer->clipPath( path );
+				break;
+			}
+			case CaptureRecord::DrawPath: {
+				uint32_t pathId, paintId;
+				p = get( p, end, pathId );
+				p = get( p, end, paintId );
+				TvgRenderPath* path = p ? findPath( pathId ) : nullptr;
+				TvgRenderPaint* paint = p ? findPaint( paintId ) : nullptr;
+				if ( !path || !paint ) p = nullptr;
+				else renderer->drawPath( path, paint );
+				break;
+			}
+			default:
+				p = nullptr;
+				break;
+		}
+	}
+	m_Failed = true;
+	return false;
+}
+
+TvgRenderPath* CaptureReader::findPath( uint32_t id ) const {
+	auto found = m_Paths.find( id );
+	return found == m_Paths.end() ? nullptr : found->second.get();
+}
+
+TvgRenderPaint* CaptureReader::findPaint( uint32_t id ) const {
+	auto found = m_Paints.find( id );
+	return found == m_Paints.end() ? nullptr : found->second.get();
+}
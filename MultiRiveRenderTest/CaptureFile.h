@@ -0,0 +1,140 @@
+#pragma once
+
+/**
+ * @file CaptureFile.h
+ * A compact binary capture of the renderer calls made over a number of frames,
+ * for benchmarking RiveRenderer and ThorVG without rive simulation.
+ *
+ * Layout, in the byte order of the machine that wrote it; captures are
+ * replayed on the same kind of machine they were recorded on:
+ *   header   "RVCP", uint32 version, uint32 width, uint32 height, uint32 frameCount
+ *   frame    float dt, uint32 byteLength, then records until End
+ *   record   uint8 type followed by its payload
+ *     PathDef   uint32 id, uint8 fillRule, uint32 cmdCount, uint32 ptsCount,
+ *               uint8 cmds[cmdCount], float pts[ptsCount * 2]
+ *     PaintDef  uint32 id, uint8 style, uint8 rgba[4], float thickness, uint8 join,
+ *               uint8 cap, uint8 blendMode, uint8 gradient (0 none, 1 linear, 2 radial),
+ *               [float x1, y1, x2, y2, uint32 stopCount, (float offset, uint8 rgba[4]) * stopCount]
+ *     Save, Restore
+ *     Transform float m[6]
+ *     ClipPath  uint32 path id
+ *     DrawPath  uint32 path id, uint32 paint id
+ *     End
+ * Paths and paints are only defined when first used or when they changed
+ * since they were last written; later frames refer to them by id.
+ */
+
+#include "RecordingRenderer.h"
+#include "RiveRenderer.h"
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+enum class CaptureRecord : uint8_t {
+	End = 0,
+	PathDef,
+	PaintDef,
+	Save,
+	Restore,
+	Transform,
+	ClipPath,
+	DrawPath
+};
+
+/**
+ * @brief Writes recorded frames to a capture file
+ */
+class CaptureWriter {
+public:
+	~CaptureWriter();
+
+	bool open( const std::string& path, uint32_t width, uint32_t height );
+
+	/**
+	 * Append a frame. The buffer's paths must be TvgRenderPaths and its
+	 * paints TvgRenderPaints.
+	 * @param dt The time step the frame was simulated with
+	 */
+	bool writeFrame( const CommandBuffer& buffer, float dt );
+
+	/**
+	 * Write the frame count and close the file
+	 */
+	bool close();
+
+private:
+	struct PathState {
+		uint32_t id;
+		uint32_t version;
+	};
+	struct PaintState {
+		uint32_t id;
+		std::vector<uint8_t> bytes;
+	};
+
+	void writePath( TvgRenderPath* path, uint32_t id );
+	void paintBytes( TvgRenderPaint* paint, std::vector<uint8_t>& out );
+
+	FILE* m_File = nullptr;
+	uint32_t m_FrameCount = 0;
+	std::vector<uint8_t> m_Out;
+	std::vector<uint8_t> m_Scratch;
+	std::unordered_map<TvgRenderPath*, PathState> m_Paths;
+	std::unordered_map<TvgRenderPaint*, PaintState> m_Paints;
+};
+
+/**
+ * @brief Loads a capture file and replays its frames into a renderer
+ */
+class CaptureReader {
+public:
+	bool load( const std::string& path );
+
+	uint32_t width() const { return m_Width; }
+	uint32_t height() const { return m_Height; }
+	uint32_t frameCount() const { return (uint32_t)m_Frames.size(); }
+
+	/**
+	 * @return The time step the frame was captured with
+	 */
+	float frameTime( uint32_t frame ) const { return m_Frames[frame].dt; }
+
+	/**
+	 * Replay the next frame into a renderer. Frames must be replayed in order
+	 * since paths and paints are defined incrementally; call rewind() to
+	 * start again from the first frame.
+	 * @return false when there are no more frames, or the frame is corrupt
+	 */
+	bool replayNext( rive::Renderer* renderer );
+
+	/**
+	 * @return Whether replay stopped at a truncated or corrupt frame, until rewind()
+	 */
+	bool failed() const { return m_Failed; }
+
+	void rewind();
+
+private:
+	struct Frame {
+		float dt;
+		size_t offset;
+		size_t length;
+	};
+
+	// Each returns the end of the record, or nullptr if it runs past end
+	const uint8_t* readPathDef( const uint8_t* p, const uint8_t* end );
+	const uint8_t* readPaintDef( const uint8_t* p, const uint8_t* end );
+	TvgRenderPath* findPath( uint32_t id ) const;
+	TvgRenderPaint* findPaint( uint32_t id ) const;
+
+	std::vector<uint8_t> m_Data;
+	std::vector<Frame> m_Frames;
+	uint32_t m_Width = 0;
+	uint32_t m_Height = 0;
+	uint32_t m_Next = 0;
+	bool m_Failed = false;
+	std::unordered_map<uint32_t, std::unique_ptr<TvgRenderPath>> m_Paths;
+	std::unordered_map<uint32_t, std::unique_ptr<TvgRenderPaint>> m_Paints;
+};
@@ -0,0 +1,178 @@
+#include "FrameExporter.h"
+#include "ImageWriter.h"
+#include "Rive.h"
+#include "RiveSnapshot.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+
+RawFrameWriter::RawFrameWriter(const std::string& path) {
+    _fp = fopen(path.c_str(), "wb");
+    if (!_fp) std::cerr << "Unable to open " << path << std::endl;
+}
+
+RawFrameWriter::~RawFrameWriter() {
+    finish();
+}
+
+bool RawFrameWriter::write(int index, const uint32_t* pixels, int width, int height) {
+    if (!_fp) return false;
+    _rgba.resize((size_t)width * height * 4);
+    argbToRgba(pixels, width, width, height, _rgba.data());
+    return fwrite(_rgba.data(), 1, _rgba.size(), _fp) == _rgba.size();
+}
+
+bool RawFrameWriter::finish() {
+    if (!_fp) return false;
+    bool ok = fclose(_fp) == 0;
+    _fp = nullptr;
+    return ok;
+}
+
+bool PngSequenceWriter::write(int index, const uint32_t* pixels, int width, int height) {
+    char path[1024];
+    snprintf(path, sizeof(path), _pattern.c_str(), index);
+    return writePng(path, pixels, width, width, height);
+}
+
+PipeFrameWriter::PipeFrameWriter(const std::string& command) {
+#ifdef _WIN32
+    _pipe = _popen(command.c_str(), "wb");
+#else
+    _pipe = popen(command.c_str(), "w");
+#endif
+    if (!_pipe) std::cerr << "Unable to start " << command << std::endl;
+}
+
+PipeFrameWriter::~PipeFrameWriter() {
+    finish();
+}
+
+bool PipeFrameWriter::write(int index, const uint32_t* pixels, int width, int height) {
+    if (!_pipe) return false;
+    _rgba.resize((size_t)width * height * 4);
+    argbToRgba(pixels, width, width, height, _rgba.data());
+    return fwrite(_rgba.data(), 1, _rgba.size(), _pipe) == _rgba.size();
+}
+
+bool PipeFrameWriter::finish() {
+    if (!_pipe) return false;
+#ifdef _WIN32
+    bool ok = _pclose(_pipe) == 0;
+#else
+    bool ok = pclose(_pipe) == 0;
+#endif
+    _pipe = nullptr;
+    return ok;
+}
+
+FrameExporter::FrameExporter(const unsigned char* data, const int len, const ExportOptions& options) :
+    _data(data), _len(len), _options(options) {
+}
+
+bool FrameExporter::run(FrameWriter* writer, TaskSystem& tasks) {
+    // Workers wait for the writer to catch up, which can't happen if they
+    // run inline on the writer's thread
+    if (tasks.workerThreads() == 0) {
+        std::cerr << "Exporting needs at least one worker thread" << std::endl;
+        return false;
+    }
+    int threads = _options.threads > 0 ? std::min(_options.threads, tasks.workerThreads()) : tasks.workerThreads();
+    int depth = _options.queueDepth > 0 ? _options.queueDepth : threads * 2;
+    int width = _options.width;
+    int height = _options.height;
+    size_t pixelCount = (size_t)width * height;
+
+    // The file is imported once, workers clone their instance from this
+    std::unique_ptr<RiveSnapshot> snapshot;
+    int frames = _options.frames;
+    {
+        auto probeCanvas = tvg::SwCanvas::gen();
+        Rive probe(_data, _len, probeCanvas.get());
+        if (frames <= 0) frames = std::max(1, (int)(probe.duration() * _options.fps + 0.5));
+        snapshot.reset(new RiveSnapshot(probe));
+        probeCanvas->clear(false);
+    }
+
+    // Frame n is rendered into slot n % depth. A worker may only start frame
+    // n once frame n - depth has been written, so slots are never shared and
+    // at most depth frames are held in memory.
+    std::vector<std::vector<uint32_t>> slots(depth, std::vector<uint32_t>(pixelCount));
+    std::vector<char> ready(depth, 0);
+    std::mutex mutex;
+    std::condition_variable workerCv;
+    std::condition_variable writerCv;
+    int next = 0;
+    int written = 0;
+    bool failed = false;
+
+    auto worker = [&]() {
+        auto canvas = tvg::SwCanvas::gen();
+        std::unique_ptr<Rive> instance;
+        {
+            // Clones only read the snapshot, but rive makes no promises about
+            // instancing an artboard from several threads
+            std::lock_guard<std::mutex> lock(mutex);
+            instance = snapshot->clone(canvas.get());
+        }
+        Rive& rive = *instance;
+        rive.fit((float)width, (float)height);
+
+        while (true) {
+            int index;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workerCv.wait(lock, [&] { return failed || next >= frames || next < written + depth; });
+                if (failed || next >= frames) break;
+                index = next++;
+            }
+
+            uint32_t* buffer = slots[index % depth].data();
+            canvas->target(buffer, width, width, height, tvg::SwCanvas::ARGB8888);
+            rive.seek(index / _options.fps);
+            canvas->update(rive.scene());
+            tasks.raster(canvas.get());
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                ready[index % depth] = 1;
+            }
+            writerCv.notify_one();
+        }
+
+        // The canvas does not own the scene, detach it before the Rive goes away
+        canvas->clear(false);
+    };
+
+    for (int i = 0; i < threads; i++) tasks.submit(worker);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int index = 0; index < frames; index++) {
+        int slot = index % depth;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            writerCv.wait(lock, [&] { return ready[slot] != 0; });
+        }
+
+        bool ok = writer->write(index, slots[slot].data(), width, height);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ready[slot] = 0;
+            written++;
+            if (!ok) failed = true;
+        }
+        workerCv.notify_all();
+        if (!ok) break;
+    }
+
+    tasks.wait();
+    bool ok = writer->finish() && !failed;
+
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000000.0;
+    std::cout << "Exported " << written << " frames in " << seconds << "s ("
+        << (seconds > 0 ? written / seconds : 0) << " frames/sec, " << threads << " threads)" << std::endl;
+    return ok;
+}
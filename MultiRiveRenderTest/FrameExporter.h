@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../common/TaskSystem.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @file FrameExporter.h
+ * Offline export of an animation to a stream of frames. Frames are rendered
+ * out of order by worker threads, each with its own artboard and canvas, and
+ * handed to a FrameWriter strictly in order through a bounded reorder queue,
+ * so memory use does not grow with the length of the animation.
+ */
+
+/**
+ * @brief Receives finished frames in order
+ */
+class FrameWriter {
+public:
+    virtual ~FrameWriter() {}
+
+    /**
+     * Write a frame
+     * @param index The frame number, always one more than the previous call
+     * @param pixels Premultiplied ARGB8888 pixels, tightly packed
+     * @return false to abort the export
+     */
+    virtual bool write(int index, const uint32_t* pixels, int width, int height) = 0;
+
+    /**
+     * Called once after the last frame
+     */
+    virtual bool finish() { return true; }
+};
+
+/**
+ * @brief Appends every frame as straight-alpha RGBA bytes to a single file
+ */
+class RawFrameWriter : public FrameWriter {
+public:
+    RawFrameWriter(const std::string& path);
+    ~RawFrameWriter();
+    bool write(int index, const uint32_t* pixels, int width, int height) override;
+    bool finish() override;
+
+protected:
+    FILE* _fp = nullptr;
+    std::vector<uint8_t> _rgba;
+};
+
+/**
+ * @brief Writes each frame to its own PNG. The path is a printf pattern
+ * taking the frame number, e.g. "frames/%05d.png"
+ */
+class PngSequenceWriter : public FrameWriter {
+public:
+    PngSequenceWriter(const std::string& pattern) : _pattern(pattern) {}
+    bool write(int index, const uint32_t* pixels, int width, int height) override;
+
+protected:
+    std::string _pattern;
+};
+
+/**
+ * @brief Streams straight-alpha RGBA frames to the stdin of an external
+ * command, e.g. "ffmpeg -f rawvideo -pix_fmt rgba -s 1000x1000 -r 60 -i - out.mp4"
+ */
+class PipeFrameWriter : public FrameWriter {
+public:
+    PipeFrameWriter(const std::string& command);
+    ~PipeFrameWriter();
+    bool write(int index, const uint32_t* pixels, int width, int height) override;
+    bool finish() override;
+
+protected:
+    FILE* _pipe = nullptr;
+    std::vector<uint8_t> _rgba;
+};
+
+struct ExportOptions {
+    int width = 1000;
+    int height = 1000;
+    double fps = 60;
+    // Number of frames to render. 0 renders the animation's duration
+    int frames = 0;
+    // Number of render threads. 0 uses every worker of the task system
+    int threads = 0;
+    // Maximum number of frames in flight. 0 uses twice the thread count
+    int queueDepth = 0;
+};
+
+/**
+ * @brief Renders frames of a rive file across worker threads and streams
+ * them, in order, to a FrameWriter
+ */
+class FrameExporter {
+public:
+    FrameExporter(const unsigned char* data, const int len, const ExportOptions& options);
+
+    /**
+     * Render all frames on the task system's workers, writing them from the
+     * calling thread. Blocks until the export is complete.
+     * @return true if every frame was rendered and written
+     */
+    bool run(FrameWriter* writer, TaskSystem& tasks);
+
+protected:
+    const unsigned char* _data;
+    int _len;
+    ExportOptions _options;
+};
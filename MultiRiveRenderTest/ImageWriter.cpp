@@ -0,0 +1,105 @@
+#include "ImageWriter.h"
+#include "PixelConvert.h"
+#include <array>
+#include <cstring>
+
+static std::array<uint32_t, 256> makeCrcTable() {
+    std::array<uint32_t, 256> table;
+    for (uint32_t n = 0; n < 256; n++) {
+        uint32_t c = n;
+        for (int k = 0; k < 8; k++) c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+        table[n] = c;
+    }
+    return table;
+}
+
+static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t len) {
+    // Images are written from several threads, a local static is built once
+    // whichever gets here first
+    static const std::array<uint32_t, 256> crcTable = makeCrcTable();
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) crc = crcTable[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void putBE32(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(v >> 24);
+    out.push_back(v >> 16);
+    out.push_back(v >> 8);
+    out.push_back(v);
+}
+
+static bool writeChunk(FILE* fp, const char* type, const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> chunk;
+    chunk.reserve(data.size() + 12);
+    putBE32(chunk, (uint32_t)data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    putBE32(chunk, crc32(0, chunk.data() + 4, data.size() + 4));
+    return fwrite(chunk.data(), 1, chunk.size(), fp) == chunk.size();
+}
+
+void argbToRgba(const uint32_t* src, int stride, int width, int height, uint8_t* dst) {
+    // RGBA bytes are ABGR8888 pixels on little endian machines
+    convertPixels(src, stride, PixelFormat::ARGB8888, (uint32_t*)dst, width, PixelFormat::ABGR8888S, width, height);
+}
+
+bool writePng(FILE* fp, const uint8_t* rgba, int width, int height) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    if (fwrite(signature, 1, 8, fp) != 8) return false;
+
+    std::vector<uint8_t> header;
+    putBE32(header, width);
+    putBE32(header, height);
+    header.push_back(8); // bit depth
+    header.push_back(6); // RGBA
+    header.push_back(0); // deflate
+    header.push_back(0); // adaptive filtering
+    header.push_back(0); // no interlace
+    if (!writeChunk(fp, "IHDR", header)) return false;
+
+    // Scanlines are prefixed with filter type 0 and wrapped in stored deflate
+    // blocks of at most 65535 bytes
+    size_t rowBytes = (size_t)width * 4;
+    size_t rawSize = (rowBytes + 1) * height;
+    std::vector<uint8_t> raw(rawSize);
+    for (int y = 0; y < height; y++) {
+        raw[y * (rowBytes + 1)] = 0;
+        memcpy(&raw[y * (rowBytes + 1) + 1], rgba + y * rowBytes, rowBytes);
+    }
+
+    std::vector<uint8_t> idat;
+    idat.reserve(rawSize + rawSize / 65535 * 5 + 16);
+    idat.push_back(0x78);
+    idat.push_back(0x01);
+    uint32_t s1 = 1, s2 = 0;
+    size_t pos = 0;
+    do {
+        size_t len = rawSize - pos < 65535 ? rawSize - pos : 65535;
+        idat.push_back(pos + len == rawSize ? 1 : 0);
+        idat.push_back(len & 255);
+        idat.push_back(len >> 8);
+        idat.push_back(~len & 255);
+        idat.push_back((~len >> 8) & 255);
+        for (size_t i = 0; i < len; i++) {
+            s1 = (s1 + raw[pos + i]) % 65521;
+            s2 = (s2 + s1) % 65521;
+        }
+        idat.insert(idat.end(), raw.begin() + pos, raw.begin() + pos + len);
+        pos += len;
+    } while (pos < rawSize);
+    putBE32(idat, (s2 << 16) | s1);
+    if (!writeChunk(fp, "IDAT", idat)) return false;
+
+    return writeChunk(fp, "IEND", std::vector<uint8_t>());
+}
+
+bool writePng(const std::string& path, const uint32_t* argb, int stride, int width, int height) {
+    FILE* fp = fopen(path.c_str(), "wb");
+    if (!fp) return false;
+    std::vector<uint8_t> rgba((size_t)width * height * 4);
+    argbToRgba(argb, stride, width, height, rgba.data());
+    bool ok = writePng(fp, rgba.data(), width, height);
+    fclose(fp);
+    return ok;
+}
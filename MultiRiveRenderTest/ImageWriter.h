@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @file ImageWriter.h
+ * Minimal, dependency free image output for ThorVG ARGB8888 buffers.
+ * PNGs are written with stored (uncompressed) deflate blocks, so they are
+ * large but need nothing beyond the standard library.
+ */
+
+/**
+ * Convert premultiplied ARGB8888 pixels (as rendered by ThorVG) into
+ * straight-alpha RGBA bytes.
+ * @param src The source pixels
+ * @param stride The source stride in pixels
+ * @param width The width in pixels
+ * @param height The height in pixels
+ * @param dst Receives width * height * 4 bytes
+ */
+void argbToRgba(const uint32_t* src, int stride, int width, int height, uint8_t* dst);
+
+/**
+ * Encode RGBA bytes as a PNG and write them to a stream.
+ * @return true on success
+ */
+bool writePng(FILE* fp, const uint8_t* rgba, int width, int height);
+
+/**
+ * Encode a premultiplied ARGB8888 buffer as a PNG file.
+ * @return true on success
+ */
+bool writePng(const std::string& path, const uint32_t* argb, int stride, int width, int height);
@@ -3,114 +3,236 @@
 
 #include "juiceriv.h"
 #include "thorvg.h"
-#include "RiveRenderer.h"
-#include "artboard.hpp"
-#include "animation/linear_animation_instance.hpp"
-#include "core/binary_reader.hpp"
-#include "file.hpp"
+#include "Rive.h"
+#include "RivePool.h"
+#include "RiveScheduler.h"
+#include "FrameExporter.h"
+#include "CaptureFile.h"
+#include "../common/TaskSystem.h"
 #include <thread>
 #include <iostream>
 #include <chrono>
+#include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/**
+ * Export the animation instead of running it.
+ * Usage: MultiRiveRenderTest --export <target> [--fps 60] [--frames N] [--size 1000x1000] [--threads N] [--pin]
+ * A target starting with '|' is a command to pipe RGBA frames to, a target
+ * ending in .png is a printf pattern for a PNG sequence, anything else is a
+ * raw RGBA file.
+ */
+int exportFrames(int argc, char* argv[], TaskSystem& tasks) {
+    std::string target;
+    ExportOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--export" && hasValue) target = argv[++i];
+        else if (arg == "--fps" && hasValue) options.fps = atof(argv[++i]);
+        else if (arg == "--frames" && hasValue) options.frames = atoi(argv[++i]);
+        else if (arg == "--size" && hasValue) sscanf(argv[++i], "%dx%d", &options.width, &options.height);
+    }
 
-class Rive {
-public:
-    Rive(const unsigned char* data, const int len, tvg::SwCanvas* canvas);
-    ~Rive();
-
-    void position(float x, float y, float r);
-    void update(double dt, tvg::SwCanvas* canvas);
-
-protected:
-    std::unique_ptr<tvg::Scene> _scene;
-    tvg::Scene* _sceneRef = nullptr;
-    rive::File* _file = nullptr;
-    rive::Artboard* _artboard = nullptr;
-    rive::LinearAnimationInstance* _animation = nullptr;
-    double _rotation;
-    float _x;
-    float _y;
-    RiveRenderer* _renderer;
-};
+    std::unique_ptr<FrameWriter> writer;
+    if (target.size() > 1 && target[0] == '|') {
+        writer.reset(new PipeFrameWriter(target.substr(1)));
+    }
+    else if (target.size() > 4 && target.compare(target.size() - 4, 4, ".png") == 0) {
+        writer.reset(new PngSequenceWriter(target));
+    }
+    else {
+        writer.reset(new RawFrameWriter(target));
+    }
 
-Rive::Rive(const unsigned char* data, const int len, tvg::SwCanvas* canvas) {
-    _scene = tvg::Scene::gen();
-    _sceneRef = _scene.get();
-    _renderer = new RiveRenderer(_sceneRef);
-
-    // _sceneRef is a "Scene*". 
-    // I overloaded Canvas::push to allow this.
-    // How can I achieve this example code without this overload?
-    canvas->push(_sceneRef);
-
-    auto reader = rive::BinaryReader((uint8_t*)data, len);
-    auto result = rive::File::import(reader, &_file);
-    _artboard = _file->artboard();
-    _artboard->advance(0.0f);
-    _animation = new rive::LinearAnimationInstance(_artboard->animation(0));
+    FrameExporter exporter(juiceriv_data, juiceriv_data_len, options);
+    bool ok = exporter.run(writer.get(), tasks);
+    tasks.printStats(std::cout);
+    return ok ? 0 : 1;
 }
 
-Rive::~Rive() {
-    delete _renderer;
-}
+/**
+ * Detaches a canvas's scenes without freeing them when it goes out of scope.
+ * A Rive owns the scene it pushes, declare this after the Rive so the canvas
+ * lets go of the scene first on every return path.
+ */
+struct CanvasDetach {
+    tvg::SwCanvas* canvas;
+    ~CanvasDetach() { canvas->clear(false); }
+};
 
-void Rive::position(float x, float y, float r) {
-    _x = x;
-    _y = y;
-    _rotation = r;
-}
+/**
+ * Capture the renderer calls of the animation for replay by RiveCaptureReplay.
+ * Usage: MultiRiveRenderTest --capture <file> [--fps 60] [--frames N] [--size 1000x1000] [--cull]
+ * Frames are sampled at fixed times so captures of the same file match.
+ * --cull removes draws hidden under opaque shapes and reports the savings.
+ */
+int captureFrames(int argc, char* argv[]) {
+    std::string target;
+    double fps = 60;
+    int frames = 0;
+    int width = 1000;
+    int height = 1000;
+    bool cull = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--capture" && hasValue) target = argv[++i];
+        else if (arg == "--cull") cull = true;
+        else if (arg == "--fps" && hasValue) fps = atof(argv[++i]);
+        else if (arg == "--frames" && hasValue) frames = atoi(argv[++i]);
+        else if (arg == "--size" && hasValue) sscanf(argv[++i], "%dx%d", &width, &height);
+    }
+    if (target.empty() || fps <= 0 || width <= 0 || height <= 0) return 1;
 
-void Rive::update(double dt, tvg::SwCanvas* canvas) {
-    if (_artboard) {
-        if (_animation) {
-            _animation->advance(dt);
-            _animation->apply(_artboard);
+    std::unique_ptr<tvg::SwCanvas> canvas = tvg::SwCanvas::gen();
+    Rive rive(juiceriv_data, juiceriv_data_len, canvas.get());
+    CanvasDetach detach{ canvas.get() };
+    rive.fit(width, height);
+    rive.recording(true);
+    rive.occlusionCulling(cull);
+    if (frames <= 0) frames = std::max(1, (int)std::ceil(rive.duration() * fps));
+
+    CaptureWriter writer;
+    if (!writer.open(target, width, height)) {
+        std::cerr << "Failed to open " << target << std::endl;
+        return 1;
+    }
+    OcclusionStats occlusion;
+    for (int i = 0; i < frames; i++) {
+        rive.seek(i / fps);
+        occlusion += rive.occlusionStats();
+        if (!writer.writeFrame(rive.commands(), (float)(1 / fps))) {
+            std::cerr << "Failed to write frame " << i << std::endl;
+            return 1;
         }
+    }
+    if (!writer.close()) return 1;
+    std::cout << "Captured " << frames << " frames to " << target << std::endl;
+    if (cull) {
+        // Overdraw is the drawn area over the canvas area, per frame
+        double canvasArea = (double)width * height * frames;
+        std::cout << "Culled " << occlusion.culled << " of " << occlusion.draws << " draws using "
+            << occlusion.occluders << " occluders, " << int(occlusion.culledFraction() * 100) << "% of the drawn area. Overdraw "
+            << occlusion.drawnArea / canvasArea << "x -> " << (occlusion.drawnArea - occlusion.culledArea) / canvasArea << "x" << std::endl;
+    }
+    return 0;
+}
 
-        rive::Mat2D m;
-        rive::Mat2D::fromRotation(m, _rotation);
-        m[4] = _x; // tx
-        m[5] = _y; // ty
-
-        _artboard->advance(dt);
-        _sceneRef->clear();
-        _renderer->save();
-        _renderer->transform(m);
-        _artboard->draw(_renderer);
-        _renderer->restore();
+/**
+ * Bake the animation into flat tracks for deployment, see BakedAnimation.
+ * Usage: MultiRiveRenderTest --bake <file> [--sample-rate N]
+ * The sample rate defaults to the animation's fps.
+ */
+int bakeAnimation(int argc, char* argv[]) {
+    std::string target;
+    float sampleRate = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--bake" && hasValue) target = argv[++i];
+        else if (arg == "--sample-rate" && hasValue) sampleRate = (float)atof(argv[++i]);
+    }
+    if (target.empty()) return 1;
 
-        canvas->update(_sceneRef);
+    std::unique_ptr<tvg::SwCanvas> canvas = tvg::SwCanvas::gen();
+    Rive rive(juiceriv_data, juiceriv_data_len, canvas.get());
+    CanvasDetach detach{ canvas.get() };
+    auto baked = rive.bakeAnimation(sampleRate);
+    if (!baked || !baked->save(target)) {
+        std::cerr << "Failed to bake " << target << std::endl;
+        return 1;
     }
+    std::cout << "Baked " << baked->trackCount() << " tracks, " << baked->frameCount() << " frames at "
+        << baked->sampleRate() << "fps, " << baked->valueBytes() << " bytes to " << target << std::endl;
+    return 0;
 }
 
-int main()
+/**
+ * Usage: MultiRiveRenderTest [--threads N] [--raster-threads N] [--pin] [--baked file]
+ * --threads is the thread budget shared by ThorVG and our workers, by
+ * default the CPUs the process may use. --raster-threads is ThorVG's share,
+ * by default all of it, or none when exporting since export workers
+ * rasterize their own canvases. --pin pins each worker to a CPU. --baked plays an
+ * animation written by --bake instead of evaluating keyframes.
+ */
+int main(int argc, char* argv[])
 {
-    // Initialise thorvg
-    tvg::Initializer::init(tvg::CanvasEngine::Sw, std::thread::hardware_concurrency());
+    TaskSystem::Options taskOptions;
+    bool exporting = false;
+    bool capturing = false;
+    bool baking = false;
+    std::string bakedPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--threads" && hasValue) taskOptions.threads = atoi(argv[++i]);
+        else if (arg == "--raster-threads" && hasValue) taskOptions.rasterThreads = atoi(argv[++i]);
+        else if (arg == "--pin") taskOptions.pin = true;
+        else if (arg == "--export") exporting = true;
+        else if (arg == "--capture") capturing = true;
+        else if (arg == "--bake") baking = true;
+        else if (arg == "--baked" && hasValue) bakedPath = argv[++i];
+    }
+    // Only export has work for the workers, otherwise ThorVG gets the whole
+    // budget unless told otherwise
+    if (taskOptions.rasterThreads < 0) {
+        if (exporting) taskOptions.rasterThreads = 0;
+        else taskOptions.rasterThreads = taskOptions.threads > 0 ? taskOptions.threads : TaskSystem::availableCpus();
+    }
+
+    // Initialises thorvg with its share of the threads
+    TaskSystem tasks(taskOptions);
+
+    if (exporting) return exportFrames(argc, argv, tasks);
+    if (capturing) return captureFrames(argc, argv);
+    if (baking) return bakeAnimation(argc, argv);
 
     // Create a buffer and SwCanvas (and attach)
-    uint32_t buffer = uint32_t(1000*1000);
+    std::vector<uint32_t> buffer(1000 * 1000);
     std::unique_ptr<tvg::SwCanvas> canvas = tvg::SwCanvas::gen();
-    canvas->target(&buffer, 1000, 100, 100, tvg::SwCanvas::ARGB8888);
-
-    // Create three rive files and position them
-    Rive* rive1 = new Rive(juiceriv_data, juiceriv_data_len, canvas.get());
+    canvas->target(buffer.data(), 1000, 1000, 1000, tvg::SwCanvas::ARGB8888);
+
+    // Create three rive instances up front and position them
+    RivePool pool(juiceriv_data, juiceriv_data_len, canvas.get());
+    pool.viewport(1000, 1000);
+    if (!bakedPath.empty()) {
+        auto baked = std::make_shared<BakedAnimation>();
+        if (!baked->load(bakedPath)) {
+            std::cerr << "Failed to load " << bakedPath << std::endl;
+            return 1;
+        }
+        pool.bakedAnimation(baked);
+    }
+    pool.prewarm(3);
+    Rive* rive1 = pool.acquire();
     rive1->position(400, 400, 0);
-    Rive* rive2 = new Rive(juiceriv_data, juiceriv_data_len, canvas.get());
+    Rive* rive2 = pool.acquire();
     rive2->position(700, 600, 2);
-    Rive* rive3 = new Rive(juiceriv_data, juiceriv_data_len, canvas.get());
+    Rive* rive3 = pool.acquire();
     rive3->position(500, 800, 4);
-    
-    // Now animate in a loop
-    double r = 0;
+
+    // Slow down the less important instances when frames run long
+    RiveScheduler scheduler;
+    scheduler.add(rive1, RiveScheduler::High);
+    scheduler.add(rive2, RiveScheduler::Normal);
+    scheduler.add(rive3, RiveScheduler::Low);
+
+    // Now animate in a loop. The scenes stay on the canvas, instances that
+    // skip a frame keep showing their last one.
     auto start = std::chrono::steady_clock::now();
     while (true) {
         auto end = std::chrono::steady_clock::now();
         double dt = (double)(std::chrono::duration_cast<std::chrono::microseconds>(end - start).count() / 1000000.0f);
         start = end;
 
-        canvas->clear(false);
-        rive1->update(dt, canvas.get());
-        rive2->update(dt, canvas.get());
-        rive3->update(dt, canvas.get());
+        scheduler.update(dt, canvas.get());
+        tasks.raster(canvas.get());
+
+        auto done = std::chrono::steady_clock::now();
+        scheduler.frameTime(std::chrono::duration_cast<std::chrono::microseconds>(done - end).count() / 1000000.0);
     }
 }
@@ -0,0 +1,228 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+
+static tvg::Point apply( const rive::Mat2D& m, const tvg::Point& p ) {
+	return { p.x * m[0] + p.y * m[2] + m[4], p.x * m[1] + p.y * m[3] + m[5] };
+}
+
+static float cross( const tvg::Point& o, const tvg::Point& a, const tvg::Point& b ) {
+	return ( a.x - o.x ) * ( b.y - o.y ) - ( a.y - o.y ) * ( b.x - o.x );
+}
+
+OcclusionStats& OcclusionStats::operator+=( const OcclusionStats& other ) {
+	draws += other.draws;
+	culled += other.culled;
+	occluders += other.occluders;
+	drawnArea += other.drawnArea;
+	culledArea += other.culledArea;
+	return *this;
+}
+
+bool OcclusionCuller::drawBounds( TvgRenderPath* path, const TvgPaint* paint, const rive::Mat2D& m, Bounds& out ) {
+	rive::AABB bounds;
+	if ( !path->computeDrawBounds( m, *paint, bounds ) ) return false;
+	out = { bounds.minX, bounds.minY, bounds.maxX, bounds.maxY };
+	return true;
+}
+
+bool OcclusionCuller::convexPolygon( TvgRenderPath* path, const rive::Mat2D& m ) {
+	const tvg::PathCommand* cmds = path->commands.data();
+	const tvg::Point* pts = path->points.data();
+	uint32_t cmdCnt = (uint32_t)path->commands.size();
+	if ( cmdCnt < 3 || cmds[0] != tvg::PathCommand::MoveTo ) return false;
+
+	// One contour only. The control polygon must turn the same way at every
+	// vertex and its x direction may only reverse twice, which rules out
+	// self intersecting outlines that still turn one way.
+	size_t start = m_Polygons.size();
+	float turn = 0;
+	int xFlips = 0;
+	float lastDx = 0;
+	uint32_t p = 0;
+	auto& control = m_Control;
+	control.clear();
+	for ( uint32_t i = 0; i < cmdCnt; i++ ) {
+		switch ( cmds[i] ) {
+			case tvg::PathCommand::MoveTo:
+				if ( i != 0 ) {
+					m_Polygons.resize( start );
+					return false;
+				}
+				control.push_back( apply( m, pts[p] ) );
+				m_Polygons.push_back( control.back() );
+				p++;
+				break;
+			case tvg::PathCommand::LineTo:
+				control.push_back( apply( m, pts[p] ) );
+				m_Polygons.push_back( control.back() );
+				p++;
+				break;
+			case tvg::PathCommand::CubicTo: {
+				// Points on the curve of a convex outline are inside it, a few
+				// samples along each curve make the polygon hug it closely
+				tvg::Point from = control.back();
+				control.push_back( apply( m, pts[p] ) );
+				control.push_back( apply( m, pts[p + 1] ) );
+				control.push_back( apply( m, pts[p + 2] ) );
+				const tvg::Point* c = &control[control.size() - 3];
+				for ( float t : { 0.25f, 0.5f, 0.75f } ) {
+					float u = 1 - t;
+					float a = u * u * u, b = 3 * u * u * t, d = 3 * u * t * t, e = t * t * t;
+					m_Polygons.push_back( { a * from.x + b * c[0].x + d * c[1].x + e * c[2].x,
+						a * from.y + b * c[0].y + d * c[1].y + e * c[2].y } );
+				}
+				m_Polygons.push_back( c[2] );
+				p += 3;
+				break;
+			}
+			case tvg::PathCommand::Close:
+				if ( i != cmdCnt - 1 ) {
+					m_Polygons.resize( start );
+					return false;
+				}
+				break;
+		}
+	}
+
+	size_t n = control.size();
+	bool convex = n >= 3;
+	for ( size_t i = 0; convex && i < n; i++ ) {
+		const tvg::Point& a = control[i];
+		const tvg::Point& b = control[( i + 1 ) % n];
+		const tvg::Point& c = control[( i + 2 ) % n];
+		float z = cross( a, b, c );
+		if ( z != 0 ) {
+			if ( turn == 0 ) turn = z;
+			else if ( ( z > 0 ) != ( turn > 0 ) ) convex = false;
+		}
+		float dx = b.x - a.x;
+		if ( dx != 0 ) {
+			if ( lastDx != 0 && ( dx > 0 ) != ( lastDx > 0 ) ) xFlips++;
+			lastDx = dx;
+		}
+	}
+	if ( !convex || turn == 0 || xFlips > 2 || m_Polygons.size() - start < 3 ) {
+		m_Polygons.resize( start );
+		return false;
+	}
+
+	// Keep every outline counter-clockwise so containment is one sign test
+	if ( turn < 0 ) std::reverse( m_Polygons.begin() + start, m_Polygons.end() );
+	return true;
+}
+
+bool OcclusionCuller::contains( const Occluder& occluder, const Bounds& bounds ) const {
+	// Antialiased edges reach into the next pixel, on both the draw and the
+	// occluder, so a draw must stay a pixel clear of the occluder's edges
+	Bounds padded = { bounds.minX - 1, bounds.minY - 1, bounds.maxX + 1, bounds.maxY + 1 };
+	if ( padded.minX < occluder.bounds.minX || padded.minY < occluder.bounds.minY ||
+		padded.maxX > occluder.bounds.maxX || padded.maxY > occluder.bounds.maxY ) return false;
+
+	const tvg::Point corners[4] = {
+		{ padded.minX, padded.minY }, { padded.maxX, padded.minY },
+		{ padded.maxX, padded.maxY }, { padded.minX, padded.maxY }
+	};
+	const tvg::Point* polygon = m_Polygons.data() + occluder.polygonStart;
+	size_t n = occluder.polygonSize;
+	for ( size_t i = 0; i < n; i++ ) {
+		const tvg::Point& a = polygon[i];
+		const tvg::Point& b = polygon[( i + 1 ) % n];
+		for ( const auto& corner : corners ) {
+			if ( cross( a, b, corner ) < 0 ) return false;
+		}
+	}
+	return true;
+}
+
+OcclusionStats OcclusionCuller::cull( CommandBuffer& buffer ) {
+	OcclusionStats stats;
+	m_Draws.clear();
+	m_Polygons.clear();
+	m_Stack.clear();
+
+	// Walk forward to find each draw's transform. RiveRenderer keeps the first
+	// clip for the rest of the frame, so nothing after a clip can occlude.
+	rive::Mat2D current;
+	bool clipped = false;
+	for ( size_t i = 0; i < buffer.commands.size(); i++ ) {
+		const auto& cmd = buffer.commands[i];
+		switch ( cmd.op ) {
+			case RenderOp::Save:
+				m_Stack.push_back( current );
+				break;
+			case RenderOp::Restore:
+				if ( !m_Stack.empty() ) {
+					current = m_Stack.back();
+					m_Stack.pop_back();
+				}
+				break;
+			case RenderOp::Transform:
+				current = current * buffer.transforms[cmd.a];
+				break;
+			case RenderOp::ClipPath:
+				clipped = true;
+				break;
+			case RenderOp::DrawPath: {
+				auto path = static_cast<TvgRenderPath*>( buffer.paths[cmd.a] );
+				auto paint = static_cast<TvgRenderPaint*>( buffer.paints[cmd.b] )->paint();
+				path->build();
+				Draw draw;
+				draw.command = i;
+				draw.occluder = false;
+				draw.polygonStart = m_Polygons.size();
+				draw.polygonSize = 0;
+				if ( !drawBounds( path, paint, current, draw.bounds ) ) break;
+				stats.draws++;
+				stats.drawnArea += draw.bounds.area();
+
+				if ( !clipped && paint->style == rive::RenderPaintStyle::fill && !paint->isGradient &&
+					paint->color[3] == 255 && paint->blendMode == rive::BlendMode::srcOver && convexPolygon( path, current ) ) {
+					draw.occluder = true;
+					draw.polygonSize = m_Polygons.size() - draw.polygonStart;
+				}
+				m_Draws.push_back( draw );
+				break;
+			}
+		}
+	}
+
+	// Walk back, testing each draw against the occluders drawn after it
+	m_Occluders.clear();
+	m_Culled.assign( buffer.commands.size(), false );
+	for ( size_t d = m_Draws.size(); d-- > 0; ) {
+		const Draw& draw = m_Draws[d];
+		bool hidden = false;
+		for ( const auto& occluder : m_Occluders ) {
+			if ( contains( occluder, draw.bounds ) ) {
+				hidden = true;
+				break;
+			}
+		}
+		if ( hidden ) {
+			m_Culled[draw.command] = true;
+			stats.culled++;
+			stats.culledArea += draw.bounds.area();
+			continue;
+		}
+		if ( !draw.occluder ) continue;
+
+		stats.occluders++;
+		Occluder occluder = { draw.polygonStart, draw.polygonSize, draw.bounds, draw.bounds.area() };
+		if ( m_Occluders.size() < m_MaxOccluders ) m_Occluders.push_back( occluder );
+		else {
+			// Keep the largest, they hide the most
+			auto smallest = std::min_element( m_Occluders.begin(), m_Occluders.end(),
+				[]( const Occluder& a, const Occluder& b ) { return a.area < b.area; } );
+			if ( smallest->area < occluder.area ) *smallest = occluder;
+		}
+	}
+
+	if ( stats.culled > 0 ) {
+		size_t out = 0;
+		for ( size_t i = 0; i < buffer.commands.size(); i++ ) {
+			if ( !m_Culled[i] ) buffer.commands[out++] = buffer.commands[i];
+		}
+		buffer.commands.resize( out );
+	}
+	return stats;
+}
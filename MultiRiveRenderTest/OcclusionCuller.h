@@ -0,0 +1,91 @@
+#pragma once
+
+/**
+ * @file OcclusionCuller.h
+ * Removes draws from a recorded frame that are entirely hidden under a later,
+ * opaque draw. Works on CommandBuffers recorded from TvgRenderPaths and
+ * TvgRenderPaints, before they are replayed into a RiveRenderer.
+ */
+
+#include "RecordingRenderer.h"
+#include "RiveRenderer.h"
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief What a cull pass found. Areas are of the draws' bounds, in pixels.
+ */
+struct OcclusionStats {
+	size_t draws = 0;
+	size_t culled = 0;
+	size_t occluders = 0;
+	double drawnArea = 0;
+	double culledArea = 0;
+
+	/**
+	 * @return The fraction of the drawn area that was removed
+	 */
+	double culledFraction() const { return drawnArea > 0 ? culledArea / drawnArea : 0; }
+
+	OcclusionStats& operator+=( const OcclusionStats& other );
+};
+
+/**
+ * @brief Finds draws covered by later opaque, solid, unclipped and normally
+ * blended fills of convex or rectangular paths and removes them from the
+ * buffer.
+ *
+ * Occluders are tested conservatively: only single contour paths whose
+ * control polygon is convex qualify, and only the polygon through their
+ * on-curve points is treated as covered. A draw is culled when the corners
+ * of its bounds, grown by its stroke and a pixel of antialiasing, all fall
+ * inside one occluder.
+ */
+class OcclusionCuller {
+public:
+	/**
+	 * @param maxOccluders The number of occluders each draw is tested
+	 * against, the largest ones are kept
+	 */
+	OcclusionCuller( size_t maxOccluders = 16 ) : m_MaxOccluders( maxOccluders ) {}
+
+	/**
+	 * Remove the hidden draws from a buffer
+	 * @return What was found
+	 */
+	OcclusionStats cull( CommandBuffer& buffer );
+
+private:
+	struct Bounds {
+		float minX, minY, maxX, maxY;
+		double area() const { return (double)( maxX - minX ) * ( maxY - minY ); }
+	};
+
+	struct Draw {
+		size_t command;
+		Bounds bounds;
+		bool occluder;
+		size_t polygonStart;
+		size_t polygonSize;
+	};
+
+	struct Occluder {
+		size_t polygonStart;
+		size_t polygonSize;
+		Bounds bounds;
+		double area;
+	};
+
+	bool drawBounds( TvgRenderPath* path, const TvgPaint* paint, const rive::Mat2D& m, Bounds& out );
+	bool convexPolygon( TvgRenderPath* path, const rive::Mat2D& m );
+	bool contains( const Occluder& occluder, const Bounds& bounds ) const;
+
+	size_t m_MaxOccluders;
+	std::vector<Draw> m_Draws;
+	std::vector<Occluder> m_Occluders;
+	// Occluder outlines in canvas space, wound counter-clockwise
+	std::vector<tvg::Point> m_Polygons;
+	std::vector<tvg::Point> m_Control;
+	std::vector<rive::Mat2D> m_Stack;
+	std::vector<bool> m_Culled;
+};
@@ -0,0 +1,300 @@
+#include "PixelConvert.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__SSE2__) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PIXEL_SSE2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) && defined(__aarch64__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define PIXEL_NEON 1
+#include <arm_neon.h>
+#endif
+
+// A kernel converts as many whole vectors of pixels as fit in count and
+// returns how many it did, the rest are left to the scalar loop
+typedef size_t (*PixelKernel)(const uint32_t* src, uint32_t* dst, size_t count, bool swap);
+
+struct PixelKernels {
+    const char* name;
+    PixelKernel swap;
+    PixelKernel premultiply;
+    PixelKernel unpremultiply;
+};
+
+static std::atomic<bool> simdEnabled{ true };
+
+static bool isAbgr(PixelFormat format) {
+    return format == PixelFormat::ABGR8888 || format == PixelFormat::ABGR8888S;
+}
+
+static bool isPremultiplied(PixelFormat format) {
+    return format == PixelFormat::ARGB8888 || format == PixelFormat::ABGR8888;
+}
+
+// Scalar versions, also used for the pixels left over by the kernels.
+// Buffers may come from byte arrays, so they are read and written with memcpy.
+
+static inline uint32_t swapRedBlue(uint32_t p) {
+    return (p & 0xff00ff00u) | (p >> 16 & 0xffu) | (p & 0xffu) << 16;
+}
+
+// c * a / 255, rounded to nearest
+static inline uint32_t mulDiv255(uint32_t c, uint32_t a) {
+    uint32_t t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+static inline uint32_t premultiply(uint32_t p) {
+    uint32_t a = p >> 24;
+    return a << 24 | mulDiv255(p >> 16 & 255, a) << 16 | mulDiv255(p >> 8 & 255, a) << 8 | mulDiv255(p & 255, a);
+}
+
+static inline uint32_t unpremultiply(uint32_t p) {
+    uint32_t a = p >> 24;
+    if (a == 0 || a == 255) return p;
+    uint32_t r = std::min(255u, ((p >> 16 & 255) * 255 + a / 2) / a);
+    uint32_t g = std::min(255u, ((p >> 8 & 255) * 255 + a / 2) / a);
+    uint32_t b = std::min(255u, ((p & 255) * 255 + a / 2) / a);
+    return a << 24 | r << 16 | g << 8 | b;
+}
+
+static void convertScalar(const uint32_t* src, uint32_t* dst, size_t count, bool swap, bool premultiplying, bool unpremultiplying) {
+    for (size_t i = 0; i < count; i++) {
+        uint32_t p;
+        memcpy(&p, src + i, 4);
+        if (unpremultiplying) p = unpremultiply(p);
+        if (swap) p = swapRedBlue(p);
+        if (premultiplying) p = premultiply(p);
+        memcpy(dst + i, &p, 4);
+    }
+}
+
+#ifdef PIXEL_SSE2
+
+// The SSE2 and AVX2 kernels are the same code at two widths, written once
+// as a macro over the intrinsic prefixes and vector types
+
+#define PIXEL_X86_KERNELS(NAME, ATTR, VEC, VECF, P, W)                                      \
+    ATTR static inline VEC NAME##SwapRB(VEC p) {                                             \
+        VEC low = P##_set1_epi32(0xff);                                                     \
+        return P##_or_si##W(P##_and_si##W(p, P##_set1_epi32((int)0xff00ff00u)),             \
+            P##_or_si##W(P##_and_si##W(P##_srli_epi32(p, 16), low), P##_slli_epi32(P##_and_si##W(p, low), 16))); \
+    }                                                                                        \
+                                                                                             \
+    ATTR static size_t NAME##Swap(const uint32_t* src, uint32_t* dst, size_t count, bool) {  \
+        const size_t lanes = sizeof(VEC) / 4;                                                \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= count; i += lanes) {                                             \
+            VEC p = P##_loadu_si##W((const VEC*)(src + i));                                  \
+            P##_storeu_si##W((VEC*)(dst + i), NAME##SwapRB(p));                              \
+        }                                                                                    \
+        return i;                                                                            \
+    }                                                                                        \
+                                                                                             \
+    /* Channels are widened to 16 bits, where c * a + 128 still fits */                     \
+    ATTR static inline VEC NAME##MulDiv255(VEC c) {                                          \
+        VEC a = P##_shufflehi_epi16(P##_shufflelo_epi16(c, 0xff), 0xff);                     \
+        VEC t = P##_add_epi16(P##_mullo_epi16(c, a), P##_set1_epi16(128));                   \
+        return P##_srli_epi16(P##_add_epi16(t, P##_srli_epi16(t, 8)), 8);                    \
+    }                                                                                        \
+                                                                                             \
+    ATTR static size_t NAME##Premultiply(const uint32_t* src, uint32_t* dst, size_t count, bool swap) { \
+        const size_t lanes = sizeof(VEC) / 4;                                                \
+        VEC zero = P##_setzero_si##W();                                                      \
+        VEC alpha = P##_set1_epi32((int)0xff000000u);                                        \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= count; i += lanes) {                                             \
+            VEC p = P##_loadu_si##W((const VEC*)(src + i));                                  \
+            if (swap) p = NAME##SwapRB(p);                                                   \
+            VEC lo = NAME##MulDiv255(P##_unpacklo_epi8(p, zero));                            \
+            VEC hi = NAME##MulDiv255(P##_unpackhi_epi8(p, zero));                            \
+            VEC r = P##_packus_epi16(lo, hi);                                                \
+            /* Alpha itself isn't scaled */                                                  \
+            r = P##_or_si##W(P##_andnot_si##W(alpha, r), P##_and_si##W(p, alpha));           \
+            P##_storeu_si##W((VEC*)(dst + i), r);                                            \
+        }                                                                                    \
+        return i;                                                                            \
+    }                                                                                        \
+                                                                                             \
+    /* (c * 255) / a in float, plus a half and truncated, is exactly the */                  \
+    /* rounded integer division for every c <= a. Larger c clamp to 255. */                  \
+    ATTR static inline VEC NAME##Unpremultiply1(VEC p, int shift, VECF divisor) {            \
+        VEC c = P##_and_si##W(P##_srli_epi32(p, shift), P##_set1_epi32(0xff));               \
+        VECF q = P##_div_ps(P##_mul_ps(P##_cvtepi32_ps(c), P##_set1_ps(255.0f)), divisor);   \
+        q = P##_min_ps(P##_add_ps(q, P##_set1_ps(0.5f)), P##_set1_ps(255.0f));               \
+        return P##_cvttps_epi32(q);                                                          \
+    }                                                                                        \
+                                                                                             \
+    ATTR static size_t NAME##Unpremultiply(const uint32_t* src, uint32_t* dst, size_t count, bool swap) { \
+        const size_t lanes = sizeof(VEC) / 4;                                                \
+        VEC zero = P##_setzero_si##W();                                                      \
+        int redShift = swap ? 0 : 16;                                                        \
+        int blueShift = swap ? 16 : 0;                                                       \
+        size_t i = 0;                                                                        \
+        for (; i + lanes <= count; i += lanes) {                                             \
+            VEC p = P##_loadu_si##W((const VEC*)(src + i));                                  \
+            VEC a = P##_srli_epi32(p, 24);                                                   \
+            /* Transparent pixels divide by 255 to stay as they are */                       \
+            VECF transparent = P##_castsi##W##_ps(P##_cmpeq_epi32(a, zero));                 \
+            VECF divisor = P##_or_ps(P##_and_ps(transparent, P##_set1_ps(255.0f)),           \
+                P##_andnot_ps(transparent, P##_cvtepi32_ps(a)));                             \
+            VEC r = NAME##Unpremultiply1(p, 16, divisor);                                    \
+            VEC g = NAME##Unpremultiply1(p, 8, divisor);                                     \
+            VEC b = NAME##Unpremultiply1(p, 0, divisor);                                     \
+            VEC out = P##_or_si##W(P##_slli_epi32(a, 24), P##_slli_epi32(g, 8));             \
+            out = P##_or_si##W(out, P##_or_si##W(P##_sll_epi32(r, _mm_cvtsi32_si128(redShift)), \
+                P##_sll_epi32(b, _mm_cvtsi32_si128(blueShift))));                            \
+            P##_storeu_si##W((VEC*)(dst + i), out);                                          \
+        }                                                                                    \
+        return i;                                                                            \
+    }
+
+PIXEL_X86_KERNELS(sse2, , __m128i, __m128, _mm, 128)
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_AVX2 __attribute__((target("avx2")))
+#else
+#define PIXEL_AVX2
+#endif
+
+PIXEL_X86_KERNELS(avx2, PIXEL_AVX2, __m256i, __m256, _mm256, 256)
+
+static bool cpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    // The OS must save the YMM registers too
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx || (_xgetbv(0) & 6) != 6) return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#elif defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#else
+    return false;
+#endif
+}
+
+#endif
+
+#ifdef PIXEL_NEON
+
+// Eight pixels at a time, split into one vector per byte of the pixel
+
+static size_t neonSwap(const uint32_t* src, uint32_t* dst, size_t count, bool) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t p = vld4_u8((const uint8_t*)(src + i));
+        uint8x8_t t = p.val[0];
+        p.val[0] = p.val[2];
+        p.val[2] = t;
+        vst4_u8((uint8_t*)(dst + i), p);
+    }
+    return i;
+}
+
+static inline uint8x8_t neonMulDiv255(uint8x8_t c, uint8x8_t a) {
+    uint16x8_t t = vaddq_u16(vmull_u8(c, a), vdupq_n_u16(128));
+    return vshrn_n_u16(vaddq_u16(t, vshrq_n_u16(t, 8)), 8);
+}
+
+static size_t neonPremultiply(const uint32_t* src, uint32_t* dst, size_t count, bool swap) {
+    size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        uint8x8x4_t p = vld4_u8((const uint8_t*)(src + i));
+        uint8x8x4_t r;
+        r.val[0] = neonMulDiv255(p.val[swap ? 2 : 0], p.val[3]);
+        r.val[1] = neonMulDiv255(p.val[1], p.val[3]);
+        r.val[2] = neonMulDiv255(p.val[swap ? 0 : 2], p.val[3]);
+        r.val[3] = p.val[3];
+        vst4_u8((uint8_t*)(dst + i), r);
+    }
+    return i;
+}
+
+// See the x86 version for why the float division rounds exactly
+static inline uint32x4_t neonUnpremultiply1(uint32x4_t p, uint32x4_t mask, float32x4_t divisor) {
+    float32x4_t q = vdivq_f32(vmulq_n_f32(vcvtq_f32_u32(vandq_u32(p, mask)), 255.0f), divisor);
+    return vcvtq_u32_f32(vminq_f32(vaddq_f32(q, vdupq_n_f32(0.5f)), vdupq_n_f32(255.0f)));
+}
+
+static size_t neonUnpremultiply(const uint32_t* src, uint32_t* dst, size_t count, bool swap) {
+    uint32x4_t mask = vdupq_n_u32(0xff);
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        uint32x4_t p = vld1q_u32(src + i);
+        uint32x4_t a = vshrq_n_u32(p, 24);
+        uint32x4_t transparent = vceqq_u32(a, vdupq_n_u32(0));
+        float32x4_t divisor = vbslq_f32(transparent, vdupq_n_f32(255.0f), vcvtq_f32_u32(a));
+        uint32x4_t r = neonUnpremultiply1(vshrq_n_u32(p, 16), mask, divisor);
+        uint32x4_t g = neonUnpremultiply1(vshrq_n_u32(p, 8), mask, divisor);
+        uint32x4_t b = neonUnpremultiply1(p, mask, divisor);
+        if (swap) std::swap(r, b);
+        uint32x4_t out = vorrq_u32(vshlq_n_u32(a, 24), vshlq_n_u32(r, 16));
+        out = vorrq_u32(out, vorrq_u32(vshlq_n_u32(g, 8), b));
+        vst1q_u32(dst + i, out);
+    }
+    return i;
+}
+
+#endif
+
+static const PixelKernels& simdKernels() {
+    static const PixelKernels kernels = []() -> PixelKernels {
+#if defined(PIXEL_SSE2)
+        if (cpuHasAvx2()) return { "avx2", avx2Swap, avx2Premultiply, avx2Unpremultiply };
+        return { "sse2", sse2Swap, sse2Premultiply, sse2Unpremultiply };
+#elif defined(PIXEL_NEON)
+        return { "neon", neonSwap, neonPremultiply, neonUnpremultiply };
+#else
+        return { "scalar", nullptr, nullptr, nullptr };
+#endif
+    }();
+    return kernels;
+}
+
+void convertPixels(const uint32_t* src, PixelFormat from, uint32_t* dst, PixelFormat to, size_t count) {
+    bool swap = isAbgr(from) != isAbgr(to);
+    bool premultiplying = !isPremultiplied(from) && isPremultiplied(to);
+    bool unpremultiplying = isPremultiplied(from) && !isPremultiplied(to);
+    if (!swap && !premultiplying && !unpremultiplying) {
+        if (src != dst) memmove(dst, src, count * 4);
+        return;
+    }
+
+    size_t done = 0;
+    if (simdEnabled.load(std::memory_order_relaxed)) {
+        const PixelKernels& kernels = simdKernels();
+        PixelKernel kernel = premultiplying ? kernels.premultiply : unpremultiplying ? kernels.unpremultiply : kernels.swap;
+        if (kernel) done = kernel(src, dst, count, swap);
+    }
+    convertScalar(src + done, dst + done, count - done, swap, premultiplying, unpremultiplying);
+}
+
+void convertPixels(const uint32_t* src, int srcStride, PixelFormat from,
+    uint32_t* dst, int dstStride, PixelFormat to, int width, int height) {
+    // Tightly packed images convert as one run, so the vector loops never
+    // stop at a row end
+    if (srcStride == width && dstStride == width) {
+        convertPixels(src, from, dst, to, (size_t)width * height);
+        return;
+    }
+    for (int y = 0; y < height; y++) {
+        convertPixels(src + (size_t)y * srcStride, from, dst + (size_t)y * dstStride, to, width);
+    }
+}
+
+void pixelConvertUseSimd(bool enabled) {
+    simdEnabled = enabled;
+}
+
+const char* pixelConvertKernel() {
+    return simdEnabled ? simdKernels().name : "scalar";
+}
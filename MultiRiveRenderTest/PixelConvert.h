@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @file PixelConvert.h
+ * Conversions between the 32 bit pixel formats used around ThorVG: channel
+ * order and premultiplied or straight alpha. Rows are converted with SSE2,
+ * AVX2 (when the CPU has it) or NEON, and plain C++ elsewhere. Source and
+ * destination may be the same buffer.
+ */
+
+/**
+ * Pixel formats as 32 bit values, alpha always in the top byte. Names match
+ * tvg::SwCanvas::Colorspace; on little endian machines ABGR8888 is RGBA in
+ * memory, the byte order PNG and OpenGL's GL_RGBA expect.
+ */
+enum class PixelFormat : uint8_t {
+    ARGB8888,   // premultiplied 0xAARRGGBB
+    ABGR8888,   // premultiplied 0xAABBGGRR
+    ARGB8888S,  // straight alpha 0xAARRGGBB
+    ABGR8888S   // straight alpha 0xAABBGGRR
+};
+
+/**
+ * Convert a run of pixels.
+ * @param src The source pixels, no alignment required
+ * @param dst Receives count pixels, may be src
+ */
+void convertPixels(const uint32_t* src, PixelFormat from, uint32_t* dst, PixelFormat to, size_t count);
+
+/**
+ * Convert an image row by row.
+ * @param srcStride The source stride in pixels
+ * @param dstStride The destination stride in pixels
+ */
+void convertPixels(const uint32_t* src, int srcStride, PixelFormat from,
+    uint32_t* dst, int dstStride, PixelFormat to, int width, int height);
+
+/**
+ * Turn the vector kernels off or back on, to compare them with the plain
+ * versions. On by default.
+ */
+void pixelConvertUseSimd(bool enabled);
+
+/**
+ * @return The name of the kernels in use: "avx2", "sse2", "neon" or "scalar"
+ */
+const char* pixelConvertKernel();
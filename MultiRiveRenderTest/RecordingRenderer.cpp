@@ -0,0 +1,144 @@
+#include "RecordingRenderer.h"
+
+static bool isIdentity( const rive::Mat2D& m ) {
+	return m[0] == 1 && m[1] == 0 && m[2] == 0 && m[3] == 1 && m[4] == 0 && m[5] == 0;
+}
+
+void CommandBuffer::clear() {
+	commands.clear();
+	transforms.clear();
+	paths.clear();
+	paints.clear();
+	m_PathIndex.clear();
+	m_PaintIndex.clear();
+}
+
+uint32_t CommandBuffer::intern( rive::RenderPath* path ) {
+	auto result = m_PathIndex.emplace( path, (uint32_t)paths.size() );
+	if ( result.second ) paths.push_back( path );
+	return result.first->second;
+}
+
+uint32_t CommandBuffer::intern( rive::RenderPaint* paint ) {
+	auto result = m_PaintIndex.emplace( paint, (uint32_t)paints.size() );
+	if ( result.second ) paints.push_back( paint );
+	return result.first->second;
+}
+
+void CommandBuffer::save() {
+	commands.push_back( { RenderOp::Save, 0, 0 } );
+}
+
+void CommandBuffer::restore() {
+	commands.push_back( { RenderOp::Restore, 0, 0 } );
+}
+
+void CommandBuffer::transform( const rive::Mat2D& transform ) {
+	commands.push_back( { RenderOp::Transform, (uint32_t)transforms.size(), 0 } );
+	transforms.push_back( transform );
+}
+
+void CommandBuffer::clipPath( rive::RenderPath* path ) {
+	commands.push_back( { RenderOp::ClipPath, intern( path ), 0 } );
+}
+
+void CommandBuffer::drawPath( rive::RenderPath* path, rive::RenderPaint* paint ) {
+	commands.push_back( { RenderOp::DrawPath, intern( path ), intern( paint ) } );
+}
+
+size_t CommandBuffer::dedupe() {
+	size_t before = commands.size();
+	std::vector<RenderCommand> out;
+	out.reserve( commands.size() );
+
+	for ( const auto& cmd : commands ) {
+		switch ( cmd.op ) {
+			case RenderOp::Restore:
+				// Transforms right before a restore affect nothing, and a save
+				// directly followed by its restore does nothing. Removing the
+				// pair can expose another empty pair, which the next restore
+				// will find in turn.
+				while ( !out.empty() && out.back().op == RenderOp::Transform ) out.pop_back();
+				if ( !out.empty() && out.back().op == RenderOp::Save ) {
+					out.pop_back();
+					continue;
+				}
+				break;
+			case RenderOp::Transform:
+				if ( isIdentity( transforms[cmd.a] ) ) continue;
+				if ( !out.empty() && out.back().op == RenderOp::Transform ) {
+					// Transforms accumulate, so a run collapses into their product
+					rive::Mat2D merged = transforms[out.back().a] * transforms[cmd.a];
+					out.back().a = (uint32_t)transforms.size();
+					transforms.push_back( merged );
+					continue;
+				}
+				break;
+			default:
+				break;
+		}
+		out.push_back( cmd );
+	}
+
+	commands.swap( out );
+	return before - commands.size();
+}
+
+void CommandBuffer::replay( rive::Renderer* renderer ) const {
+	for ( const auto& cmd : commands ) {
+		switch ( cmd.op ) {
+			case RenderOp::Save:
+				renderer->save();
+				break;
+			case RenderOp::Restore:
+				renderer->restore();
+				break;
+			case RenderOp::Transform:
+				renderer->transform( transforms[cmd.a] );
+				break;
+			case RenderOp::ClipPath:
+				renderer->clipPath( paths[cmd.a] );
+				break;
+			case RenderOp::DrawPath:
+				renderer->drawPath( paths[cmd.a], paints[cmd.b] );
+				break;
+		}
+	}
+}
+
+size_t CommandBuffer::drawCount() const {
+	size_t count = 0;
+	for ( const auto& cmd : commands ) {
+		if ( cmd.op == RenderOp::DrawPath ) count++;
+	}
+	return count;
+}
+
+void CommandBuffer::dump( std::ostream& out ) const {
+	int depth = 0;
+	for ( const auto& cmd : commands ) {
+		if ( cmd.op == RenderOp::Restore && depth > 0 ) depth--;
+		for ( int i = 0; i < depth; i++ ) out << "  ";
+		switch ( cmd.op ) {
+			case RenderOp::Save:
+				out << "save\n";
+				depth++;
+				break;
+			case RenderOp::Restore:
+				out << "restore\n";
+				break;
+			case RenderOp::Transform: {
+				const auto& m = transforms[cmd.a];
+				out << "transform [" << m[0] << " " << m[1] << " " << m[2] << " " << m[3] << " " << m[4] << " " << m[5] << "]\n";
+				break;
+			}
+			case RenderOp::ClipPath:
+				out << "clip path#" << cmd.a << "\n";
+				break;
+			case RenderOp::DrawPath:
+				out << "draw path#" << cmd.a << " paint#" << cmd.b << "\n";
+				break;
+		}
+	}
+	out << commands.size() << " commands, " << paths.size() << " paths, " << paints.size() << " paints\n";
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+/**
+ * @file RecordingRenderer.h
+ * A rive renderer that records draw calls into a flat command buffer instead
+ * of building ThorVG objects. The buffer can be inspected, simplified and
+ * replayed into any other rive renderer (usually a RiveRenderer) later, on
+ * any thread, as long as the recorded paths and paints are still alive.
+ */
+
+// Rive
+#include "renderer.hpp"
+// Other
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+enum class RenderOp : uint8_t {
+	Save,
+	Restore,
+	Transform,	// a: transform index
+	ClipPath,	// a: path index
+	DrawPath	// a: path index, b: paint index
+};
+
+/**
+ * @brief A single recorded call. Plain data, indices refer to the tables in
+ * the owning CommandBuffer.
+ */
+struct RenderCommand {
+	RenderOp op;
+	uint32_t a;
+	uint32_t b;
+};
+
+/**
+ * @brief The calls of one or more frames, with paths and paints interned so
+ * each appears once however often it is drawn.
+ */
+class CommandBuffer {
+public:
+	std::vector<RenderCommand> commands;
+	std::vector<rive::Mat2D> transforms;
+	std::vector<rive::RenderPath*> paths;
+	std::vector<rive::RenderPaint*> paints;
+
+	/**
+	 * Empty the buffer, keeping its capacity
+	 */
+	void clear();
+
+	void save();
+	void restore();
+	void transform( const rive::Mat2D& transform );
+	void clipPath( rive::RenderPath* path );
+	void drawPath( rive::RenderPath* path, rive::RenderPaint* paint );
+
+	/**
+	 * Remove commands that have no effect: save/restore pairs with nothing in
+	 * between, transforms right before a restore, identity transforms, and
+	 * runs of transforms (merged into one)
+	 * @return The number of commands removed
+	 */
+	size_t dedupe();
+
+	/**
+	 * Issue the recorded calls to another renderer
+	 */
+	void replay( rive::Renderer* renderer ) const;
+
+	/**
+	 * Write a readable listing of the commands
+	 */
+	void dump( std::ostream& out ) const;
+
+	size_t drawCount() const;
+
+private:
+	uint32_t intern( rive::RenderPath* path );
+	uint32_t intern( rive::RenderPaint* paint );
+
+	std::unordered_map<rive::RenderPath*, uint32_t> m_PathIndex;
+	std::unordered_map<rive::RenderPaint*, uint32_t> m_PaintIndex;
+};
+
+/**
+ * @brief Records rive draw calls into a CommandBuffer
+ */
+class RecordingRenderer : public rive::Renderer {
+private:
+	CommandBuffer* m_Buffer;
+
+public:
+	RecordingRenderer( CommandBuffer* buffer ) : m_Buffer( buffer ) {}
+	void save() override { m_Buffer->save(); }
+	void restore() override { m_Buffer->restore(); }
+	void transform( const rive::Mat2D& transform ) override { m_Buffer->transform( transform ); }
+	void drawPath( rive::RenderPath* path, rive::RenderPaint* paint ) override { m_Buffer->drawPath( path, paint ); }
+	void clipPath( rive::RenderPath* path ) override { m_Buffer->clipPath( path ); }
+};
@@ -0,0 +1,300 @@
+#include "Rive.h"
+#include "RiveSnapshot.h"
+#include "animation/linear_animation.hpp"
+#include "animation/state_machine.hpp"
+#include "animation/state_machine_bool.hpp"
+#include "animation/state_machine_input_instance.hpp"
+#include "animation/state_machine_number.hpp"
+#include "core/binary_reader.hpp"
+#include <algorithm>
+#include <cmath>
+
+// State machines can't seek, catching up replays them in at most this many
+// steps, each no shorter than minCatchUpStep
+static const int maxCatchUpSteps = 8;
+static const double minCatchUpStep = 1.0 / 60.0;
+
+Rive::Rive(const unsigned char* data, const int len, tvg::SwCanvas* canvas) {
+    attach(canvas);
+
+    rive::File* file = nullptr;
+    auto reader = rive::BinaryReader((uint8_t*)data, len);
+    auto result = rive::File::import(reader, &file);
+    _file.reset(file);
+    _artboard = _file->artboard();
+    _artboard->advance(0.0f);
+    _animation = new rive::LinearAnimationInstance(_artboard->animation(0));
+}
+
+Rive::Rive(const RiveSnapshot& snapshot, tvg::SwCanvas* canvas) {
+    attach(canvas);
+
+    _file = snapshot._file;
+    if (snapshot._artboard) {
+        // Cloning copies the captured values, advancing derives transforms
+        // and paths from them
+        _artboard = snapshot._artboard->instance();
+        _ownsArtboard = true;
+        _artboard->advance(0.0f);
+    }
+    if (snapshot._animation) _animation = new rive::LinearAnimationInstance(*snapshot._animation);
+    if (snapshot._stateMachineIndex >= 0) useStateMachine(snapshot._stateMachineIndex);
+    if (_stateMachine) {
+        size_t count = std::min(_stateMachine->inputCount(), snapshot._inputValues.size());
+        for (size_t i = 0; i < count; i++) {
+            auto inputInstance = _stateMachine->input(i);
+            if (inputInstance->input()->is<rive::StateMachineNumber>()) {
+                static_cast<rive::SMINumber*>(inputInstance)->value(snapshot._inputValues[i]);
+            }
+            else if (inputInstance->input()->is<rive::StateMachineBool>()) {
+                static_cast<rive::SMIBool*>(inputInstance)->value(snapshot._inputValues[i] != 0);
+            }
+        }
+    }
+    if (snapshot._baked) {
+        bakedAnimation(snapshot._baked);
+        if (_baked) _baked->time(snapshot._bakedTime);
+    }
+}
+
+Rive::~Rive() {
+    // The renderer empties the scene first, it holds shapes owned by the
+    // artboard's paths. The file owns the artboard unless this is a clone.
+    delete _renderer;
+    delete _animation;
+    delete _stateMachine;
+    if (_ownsArtboard) delete _artboard;
+}
+
+void Rive::attach(tvg::SwCanvas* canvas) {
+    _scene = tvg::Scene::gen();
+    _sceneRef = _scene.get();
+    _renderer = new RiveRenderer(_sceneRef);
+
+    // _sceneRef is a "Scene*".
+    // I overloaded Canvas::push to allow this.
+    // How can I achieve this example code without this overload?
+    canvas->push(_sceneRef);
+}
+
+void Rive::useStateMachine(int index) {
+    if (!_artboard || index < 0 || index >= (int)_artboard->stateMachineCount()) return;
+    delete _stateMachine;
+    _stateMachine = new rive::StateMachineInstance(_artboard->stateMachine(index), _artboard);
+    _stateMachineIndex = index;
+}
+
+std::shared_ptr<const BakedAnimation> Rive::bakeAnimation(float sampleRate) {
+    if (!_animation) return nullptr;
+    auto baked = std::make_shared<BakedAnimation>();
+    // Sampling leaves the artboard posed at the end
+    bool ok = baked->bake(_artboard->animation(0), _artboard, sampleRate);
+    _animation->apply(_artboard);
+    _artboard->advance(0.0f);
+    return ok ? baked : nullptr;
+}
+
+void Rive::bakedAnimation(std::shared_ptr<const BakedAnimation> baked) {
+    if (baked && _artboard) _baked.reset(new BakedAnimationInstance(std::move(baked), _artboard));
+    else _baked.reset();
+}
+
+void Rive::hidden(bool value) {
+    _hidden = value;
+}
+
+void Rive::viewport(float width, float height) {
+    _viewport = rive::AABB(0, 0, width, height);
+    _hasViewport = true;
+}
+
+rive::Mat2D Rive::drawTransform() const {
+    rive::Mat2D m;
+    rive::Mat2D::fromRotation(m, _rotation);
+    m[4] = _x; // tx
+    m[5] = _y; // ty
+    if (_hasFrame) {
+        rive::Mat2D alignment;
+        _renderer->computeAlignment(alignment, rive::Fit::contain, rive::Alignment::center, _frame, _artboard->bounds());
+        m = m * alignment;
+    }
+    return m;
+}
+
+rive::AABB Rive::bounds() const {
+    if (!_artboard) return rive::AABB();
+    rive::AABB local = _artboard->bounds();
+    rive::Mat2D m = drawTransform();
+
+    float xs[4] = { local.minX, local.maxX, local.maxX, local.minX };
+    float ys[4] = { local.minY, local.minY, local.maxY, local.maxY };
+    rive::AABB result(1e30f, 1e30f, -1e30f, -1e30f);
+    for (int i = 0; i < 4; i++) {
+        float x = xs[i] * m[0] + ys[i] * m[2] + m[4];
+        float y = xs[i] * m[1] + ys[i] * m[3] + m[5];
+        result.minX = std::min(result.minX, x);
+        result.minY = std::min(result.minY, y);
+        result.maxX = std::max(result.maxX, x);
+        result.maxY = std::max(result.maxY, y);
+    }
+    return result;
+}
+
+bool Rive::visible() const {
+    if (_hidden) return false;
+    if (!_hasViewport) return true;
+    rive::AABB b = bounds();
+    return b.maxX > _viewport.minX && b.minX < _viewport.maxX &&
+        b.maxY > _viewport.minY && b.minY < _viewport.maxY;
+}
+
+void Rive::reset() {
+    _x = 0;
+    _y = 0;
+    _rotation = 0;
+    _hasFrame = false;
+    _hidden = false;
+    _pendingTime = 0;
+    _heldTime = 0;
+    _drawn = false;
+    if (_baked) {
+        _baked->time(_baked->animation()->startSeconds());
+        _baked->apply();
+    }
+    else if (_animation) {
+        _animation->time(_animation->animation()->startSeconds());
+        _animation->apply(_artboard);
+    }
+    if (_artboard) _artboard->advance(0.0f);
+    _renderer->beginFrame();
+}
+
+void Rive::position(float x, float y, float r) {
+    _x = x;
+    _y = y;
+    _rotation = r;
+}
+
+void Rive::fit(float width, float height) {
+    _frame = rive::AABB(0, 0, width, height);
+    _hasFrame = true;
+}
+
+double Rive::duration() const {
+    if (_baked) return _baked->animation()->durationSeconds();
+    if (!_animation) return 0;
+    auto animation = _animation->animation();
+    return (double)animation->duration() / animation->fps();
+}
+
+void Rive::skip(double dt) {
+    _heldTime += dt;
+}
+
+void Rive::update(double dt, tvg::SwCanvas* canvas) {
+    if (_artboard) {
+        dt += _heldTime;
+        _heldTime = 0;
+
+        if (!visible()) {
+            _pendingTime += dt;
+            if (_drawn) {
+                _renderer->beginFrame();
+                _drawn = false;
+                canvas->update(_sceneRef);
+            }
+            return;
+        }
+
+        if (_pendingTime > 0) {
+            catchUp(_pendingTime);
+            _pendingTime = 0;
+        }
+
+        if (_stateMachine) {
+            _stateMachine->advance(dt);
+        }
+        else if (_baked) {
+            _baked->advance((float)dt);
+            _baked->apply();
+        }
+        else if (_animation) {
+            _animation->advance(dt);
+            _animation->apply(_artboard);
+        }
+
+        _artboard->advance(dt);
+        draw();
+
+        canvas->update(_sceneRef);
+    }
+}
+
+void Rive::catchUp(double time) {
+    if (_stateMachine) {
+        // State machines can't seek. Replay the hidden time in a bounded
+        // number of steps so transitions still happen, stopping early once
+        // the machine settles.
+        int steps = std::max(1, std::min(maxCatchUpSteps, (int)std::ceil(time / minCatchUpStep)));
+        double step = time / steps;
+        for (int i = 0; i < steps; i++) {
+            if (!_stateMachine->advance(step)) break;
+        }
+    }
+    else if (_baked) {
+        _baked->advance((float)time);
+    }
+    else if (_animation) {
+        // Advancing by any amount is a seek that honours looping; the
+        // animation is applied by the regular update that follows
+        _animation->advance(time);
+    }
+}
+
+void Rive::seek(double time) {
+    if (_artboard) {
+        if (_baked) {
+            _baked->time((float)time);
+            _baked->apply();
+        }
+        else if (_animation) {
+            _animation->time(time);
+            _animation->apply(_artboard);
+        }
+
+        _artboard->advance(0.0f);
+        draw();
+    }
+}
+
+void Rive::draw() {
+    // Keep in step with drawTransform(), which culling uses
+    rive::Mat2D m;
+    rive::Mat2D::fromRotation(m, _rotation);
+    m[4] = _x; // tx
+    m[5] = _y; // ty
+
+    _renderer->beginFrame();
+    if (_recording) {
+        _commands.clear();
+        RecordingRenderer recorder(&_commands);
+        drawTo(&recorder, m);
+        if (_cullOccluded) _occlusionStats = _culler.cull(_commands);
+        _commands.dedupe();
+        _commands.replay(_renderer);
+    }
+    else {
+        drawTo(_renderer, m);
+    }
+    _drawn = true;
+}
+
+void Rive::drawTo(rive::Renderer* renderer, const rive::Mat2D& m) {
+    renderer->save();
+    renderer->transform(m);
+    if (_hasFrame) {
+        renderer->align(rive::Fit::contain, rive::Alignment::center, _frame, _artboard->bounds());
+    }
+    _artboard->draw(renderer);
+    renderer->restore();
+}
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "thorvg.h"
+#include "RiveRenderer.h"
+#include "RecordingRenderer.h"
+#include "OcclusionCuller.h"
+#include "BakedAnimation.h"
+#include "artboard.hpp"
+#include "animation/linear_animation_instance.hpp"
+#include "animation/state_machine_instance.hpp"
+#include "file.hpp"
+#include "layout.hpp"
+#include <memory>
+
+class RiveSnapshot;
+
+/**
+ * @brief A single rive file, its artboard and first animation, drawn into a
+ * ThorVG scene that is pushed onto a canvas.
+ */
+class Rive {
+public:
+    Rive(const unsigned char* data, const int len, tvg::SwCanvas* canvas);
+    ~Rive();
+
+    void position(float x, float y, float r);
+
+    /**
+     * Advance and redraw. Instances that are hidden or entirely outside the
+     * viewport only accumulate the elapsed time, and catch up in one go when
+     * they become visible again.
+     */
+    void update(double dt, tvg::SwCanvas* canvas);
+
+    /**
+     * Let time pass without advancing or redrawing. The scene keeps showing
+     * the last frame and the time is added to the next update.
+     */
+    void skip(double dt);
+
+    /**
+     * Drive the artboard with a state machine instead of its first animation
+     * @param index The index of the state machine on the artboard
+     */
+    void useStateMachine(int index);
+
+    /**
+     * Explicitly hide or show the instance
+     */
+    void hidden(bool value);
+    bool hidden() const { return _hidden; }
+
+    /**
+     * Set the visible area of the canvas. Instances are culled against it.
+     */
+    void viewport(float width, float height);
+
+    /**
+     * @return The artboard's bounds on the canvas
+     */
+    rive::AABB bounds() const;
+
+    /**
+     * @return true if the instance would be drawn by the next update
+     */
+    bool visible() const;
+
+    /**
+     * Fit the artboard into a frame (contain, centered) instead of drawing it
+     * at its native size. Applied after the position transform.
+     * @param width The width of the frame
+     * @param height The height of the frame
+     */
+    void fit(float width, float height);
+
+    /**
+     * Apply the animation at an absolute time and rebuild the scene. Unlike
+     * update this does not depend on previous calls, so frames can be
+     * rendered in any order.
+     * @param time The animation time in seconds
+     */
+    void seek(double time);
+
+    /**
+     * @return The duration of the animation in seconds, or 0 if there is none
+     */
+    double duration() const;
+
+    /**
+     * Return to the state just after construction: animation rewound to its
+     * start, no transform or frame, nothing in the scene. Cheap enough to
+     * call every time a pooled instance is reused.
+     */
+    void reset();
+
+    /**
+     * Sample the first animation into flat tracks, see BakedAnimation
+     * @param sampleRate Samples per second, 0 for the animation's fps
+     * @return The baked animation, or null if there is nothing to bake
+     */
+    std::shared_ptr<const BakedAnimation> bakeAnimation(float sampleRate = 0);
+
+    /**
+     * Play a baked animation instead of the first animation. It must have
+     * been baked from the same file. Pass null to go back to the original.
+     */
+    void bakedAnimation(std::shared_ptr<const BakedAnimation> baked);
+
+    /**
+     * Record each frame into a command buffer, simplify it and then replay
+     * it into the ThorVG renderer, instead of drawing directly
+     */
+    void recording(bool value) { _recording = value; }
+
+    /**
+     * @return The commands recorded for the last frame, when recording
+     */
+    const CommandBuffer& commands() const { return _commands; }
+
+    /**
+     * Remove draws hidden under later opaque shapes before replaying a
+     * recorded frame. Only has an effect while recording.
+     */
+    void occlusionCulling(bool value) { _cullOccluded = value; }
+
+    /**
+     * @return What occlusion culling removed from the last frame
+     */
+    const OcclusionStats& occlusionStats() const { return _occlusionStats; }
+
+    tvg::Scene* scene() const { return _sceneRef; }
+
+protected:
+    friend class RivePool;
+    friend class RiveSnapshot;
+
+    /**
+     * Start from a snapshot instead of importing, see RiveSnapshot::clone
+     */
+    Rive(const RiveSnapshot& snapshot, tvg::SwCanvas* canvas);
+
+    void attach(tvg::SwCanvas* canvas);
+    void draw();
+    void drawTo(rive::Renderer* renderer, const rive::Mat2D& m);
+    rive::Mat2D drawTransform() const;
+    void catchUp(double time);
+
+    std::unique_ptr<tvg::Scene> _scene;
+    tvg::Scene* _sceneRef = nullptr;
+    // Shared with snapshots and their clones
+    std::shared_ptr<rive::File> _file;
+    rive::Artboard* _artboard = nullptr;
+    // Clones own their artboard instance, otherwise the file owns it
+    bool _ownsArtboard = false;
+    rive::LinearAnimationInstance* _animation = nullptr;
+    rive::StateMachineInstance* _stateMachine = nullptr;
+    int _stateMachineIndex = -1;
+    // Replaces _animation when set
+    std::unique_ptr<BakedAnimationInstance> _baked;
+    double _rotation = 0;
+    float _x = 0;
+    float _y = 0;
+    bool _hasFrame = false;
+    rive::AABB _frame;
+    bool _hidden = false;
+    bool _hasViewport = false;
+    rive::AABB _viewport;
+    // Time that passed while not visible, applied on the next visible update
+    double _pendingTime = 0;
+    // Time from skipped updates, added to the next update
+    double _heldTime = 0;
+    // Whether the scene currently holds a drawing
+    bool _drawn = false;
+    RiveRenderer* _renderer;
+    bool _recording = false;
+    CommandBuffer _commands;
+    bool _cullOccluded = false;
+    OcclusionCuller _culler;
+    OcclusionStats _occlusionStats;
+    // Index in the owning pool's active list, -1 when not in use
+    int _poolSlot = -1;
+};
@@ -0,0 +1,77 @@
+#include "RivePool.h"
+
+RivePool::RivePool(const unsigned char* data, const int len, tvg::SwCanvas* canvas) :
+    _data(data), _len(len), _canvas(canvas) {
+}
+
+Rive* RivePool::create() {
+    if (_snapshot) {
+        _instances.push_back(_snapshot->clone(_canvas));
+    }
+    else {
+        _instances.emplace_back(new Rive(_data, _len, _canvas));
+    }
+    Rive* rive = _instances.back().get();
+    if (_hasViewport) rive->viewport(_viewportWidth, _viewportHeight);
+    if (_baked) rive->bakedAnimation(_baked);
+    // Nothing is drawn until the instance is acquired and updated
+    rive->reset();
+    if (!_snapshot) _snapshot.reset(new RiveSnapshot(*rive));
+    return rive;
+}
+
+void RivePool::prewarm(size_t count) {
+    _free.reserve(count);
+    _active.reserve(count);
+    while (_instances.size() < count) {
+        _free.push_back(create());
+    }
+}
+
+Rive* RivePool::acquire() {
+    Rive* rive;
+    if (_free.empty()) {
+        rive = create();
+        _misses++;
+    }
+    else {
+        rive = _free.back();
+        _free.pop_back();
+    }
+
+    rive->_poolSlot = (int)_active.size();
+    _active.push_back(rive);
+    return rive;
+}
+
+void RivePool::release(Rive* rive) {
+    if (rive->_poolSlot < 0) return;
+
+    // Swap remove, the last active instance takes over the slot
+    Rive* last = _active.back();
+    _active[rive->_poolSlot] = last;
+    last->_poolSlot = rive->_poolSlot;
+    _active.pop_back();
+
+    rive->_poolSlot = -1;
+    rive->reset();
+    _free.push_back(rive);
+}
+
+void RivePool::viewport(float width, float height) {
+    _hasViewport = true;
+    _viewportWidth = width;
+    _viewportHeight = height;
+    for (auto& rive : _instances) rive->viewport(width, height);
+}
+
+void RivePool::bakedAnimation(std::shared_ptr<const BakedAnimation> baked) {
+    _baked = baked;
+    for (auto& rive : _instances) rive->bakedAnimation(baked);
+}
+
+void RivePool::update(double dt, tvg::SwCanvas* canvas) {
+    for (Rive* rive : _active) {
+        rive->update(dt, canvas);
+    }
+}
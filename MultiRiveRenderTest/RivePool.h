@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Rive.h"
+#include "RiveSnapshot.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Recycles Rive instances of one file so spawning and despawning never
+ * parses the file or allocates artboards during a frame.
+ *
+ * All instances share one canvas. Their scenes are pushed onto it once, when
+ * the instance is created, and released instances simply draw nothing.
+ *
+ * Only the first instance imports the file. It is snapshotted once reset and
+ * every later instance is cloned from the snapshot, see RiveSnapshot.
+ */
+class RivePool {
+public:
+    RivePool(const unsigned char* data, const int len, tvg::SwCanvas* canvas);
+
+    /**
+     * Create instances until the pool holds at least count of them
+     */
+    void prewarm(size_t count);
+
+    /**
+     * Take an instance from the pool. It is reset and ready to be positioned.
+     * Creates a new instance if none are free, which is counted as a miss.
+     */
+    Rive* acquire();
+
+    /**
+     * Return an instance to the pool
+     */
+    void release(Rive* rive);
+
+    /**
+     * Set the visible area of the canvas for every instance, see Rive::viewport
+     */
+    void viewport(float width, float height);
+
+    /**
+     * Play a baked animation on every instance, including ones created
+     * later, see Rive::bakedAnimation
+     */
+    void bakedAnimation(std::shared_ptr<const BakedAnimation> baked);
+
+    /**
+     * Update every instance in use
+     */
+    void update(double dt, tvg::SwCanvas* canvas);
+
+    size_t size() const { return _instances.size(); }
+    size_t active() const { return _active.size(); }
+    size_t misses() const { return _misses; }
+
+protected:
+    Rive* create();
+
+    const unsigned char* _data;
+    int _len;
+    tvg::SwCanvas* _canvas;
+    std::unique_ptr<RiveSnapshot> _snapshot;
+    std::vector<std::unique_ptr<Rive>> _instances;
+    std::vector<Rive*> _free;
+    std::vector<Rive*> _active;
+    size_t _misses = 0;
+    bool _hasViewport = false;
+    float _viewportWidth = 0;
+    float _viewportHeight = 0;
+    std::shared_ptr<const BakedAnimation> _baked;
+};
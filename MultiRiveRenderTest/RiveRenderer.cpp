@@ -1,18 +1,19 @@
 #include "RiveRenderer.h"
 #include "math/vec2d.hpp"
 #include "shapes/paint/color.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
 #include <iostream>
 
 
 void TvgRenderPath::fillRule( rive::FillRule value ) {
-	switch ( value ) {
-		case rive::FillRule::evenOdd:
-			tvgShape->fill( tvg::FillRule::EvenOdd );
-			break;
-		case rive::FillRule::nonZero:
-			tvgShape->fill( tvg::FillRule::Winding );
-			break;
-	}
+	tvg::FillRule rule = value == rive::FillRule::evenOdd ? tvg::FillRule::EvenOdd : tvg::FillRule::Winding;
+	if ( rule == tvgFillRule ) return;
+	tvgFillRule = rule;
+	version++;
 }
 
 tvg::Point transformCoord( const tvg::Point pt, const rive::Mat2D& transform ) {
@@ -28,47 +29,216 @@ tvg::Point transformCoord( const tvg::Point pt, const rive::Mat2D& transform ) {
 }
 
 void TvgRenderPath::reset() {
-	tvgShape->reset();
+	// Keep the current path, the rebuild is compared against it
+	m_CmdCursor = 0;
+	m_PtsCursor = 0;
+	m_Diverged = false;
 }
 
-void TvgRenderPath::addRenderPath( rive::RenderPath* path, const rive::Mat2D& transform ) {
-	const tvg::Point* pts;
-	auto ptsCnt = static_cast<TvgRenderPath*>( path )->tvgShape->pathCoords( &pts );
-	if ( !pts ) return;
+bool TvgRenderPath::matches( tvg::PathCommand cmd, const tvg::Point* pts, uint32_t ptsCnt ) {
+	if ( m_Diverged ) return false;
+	if ( m_CmdCursor < commands.size() && m_PtsCursor + ptsCnt <= points.size() && commands[m_CmdCursor] == cmd &&
+		( ptsCnt == 0 || memcmp( points.data() + m_PtsCursor, pts, ptsCnt * sizeof( tvg::Point ) ) == 0 ) ) {
+		m_CmdCursor++;
+		m_PtsCursor += ptsCnt;
+		return true;
+	}
+	diverge();
+	return false;
+}
 
-	const tvg::PathCommand* cmds;
-	auto cmdCnt = static_cast<TvgRenderPath*>( path )->tvgShape->pathCommands( &cmds );
-	if ( !cmds ) return;
+void TvgRenderPath::diverge() {
+	// Keep the matched prefix, new commands are then appended directly until
+	// the next reset. Truncating keeps the capacity.
+	commands.resize( m_CmdCursor );
+	points.resize( m_PtsCursor );
+	m_Diverged = true;
+	version++;
+}
 
-	//Capture the last coordinates
-	tvg::Point* pts2;
-	auto ptsCnt2 = tvgShape->pathCoords( const_cast<const tvg::Point**>( &pts2 ) );
+void TvgRenderPath::build() {
+	// A rebuild that stopped short of the old path still changed it
+	if ( !m_Diverged && ( m_CmdCursor != commands.size() || m_PtsCursor != points.size() ) ) diverge();
+}
 
-	tvgShape->appendPath( cmds, cmdCnt, pts, ptsCnt );
+void TvgRenderPath::toShape( tvg::Shape* shape ) const {
+	shape->reset();
+	if ( !commands.empty() && !points.empty() ) {
+		shape->appendPath( commands.data(), (uint32_t)commands.size(), points.data(), (uint32_t)points.size() );
+	}
+	shape->fill( tvgFillRule );
+}
 
-	//Immediate Transform for the newly appended
-	tvg::Point* pts3;
-	auto ptsCnt3 = tvgShape->pathCoords( const_cast<const tvg::Point**>( &pts3 ) );
+void TvgRenderPath::addRenderPath( rive::RenderPath* path, const rive::Mat2D& transform ) {
+	auto source = static_cast<TvgRenderPath*>( path );
+	source->build();
+	size_t cmdCnt = source->commands.size();
+	size_t ptsCnt = source->points.size();
+	if ( cmdCnt == 0 || ptsCnt == 0 ) return;
+
+	// Compare the transformed points against the stored ones as they are
+	// computed, nothing is copied unless they differ
+	if ( !m_Diverged ) {
+		bool same = m_CmdCursor + cmdCnt <= commands.size() && m_PtsCursor + ptsCnt <= points.size() &&
+			memcmp( commands.data() + m_CmdCursor, source->commands.data(), cmdCnt * sizeof( tvg::PathCommand ) ) == 0;
+		for ( size_t i = 0; same && i < ptsCnt; i++ ) {
+			tvg::Point p = transformCoord( source->points[i], transform );
+			const tvg::Point& old = points[m_PtsCursor + i];
+			same = p.x == old.x && p.y == old.y;
+		}
+		if ( same ) {
+			m_CmdCursor += (uint32_t)cmdCnt;
+			m_PtsCursor += (uint32_t)ptsCnt;
+			return;
+		}
+		diverge();
+	}
 
-	for ( unsigned i = ptsCnt2; i < ptsCnt3; ++i ) {
-		pts3[i] = transformCoord( pts3[i], transform );
+	//Immediate Transform for the newly appended, straight into our points
+	commands.insert( commands.end(), source->commands.begin(), source->commands.end() );
+	size_t base = points.size();
+	points.resize( base + ptsCnt );
+	for ( size_t i = 0; i < ptsCnt; ++i ) {
+		points[base + i] = transformCoord( source->points[i], transform );
 	}
+	version++;
 }
 
 void TvgRenderPath::moveTo( float x, float y ) {
-	tvgShape->moveTo( x, y );
+	tvg::Point pt = { x, y };
+	if ( matches( tvg::PathCommand::MoveTo, &pt, 1 ) ) return;
+	commands.push_back( tvg::PathCommand::MoveTo );
+	points.push_back( pt );
+	version++;
 }
 
 void TvgRenderPath::lineTo( float x, float y ) {
-	tvgShape->lineTo( x, y );
+	tvg::Point pt = { x, y };
+	if ( matches( tvg::PathCommand::LineTo, &pt, 1 ) ) return;
+	commands.push_back( tvg::PathCommand::LineTo );
+	points.push_back( pt );
+	version++;
 }
 
 void TvgRenderPath::cubicTo( float ox, float oy, float ix, float iy, float x, float y ) {
-	tvgShape->cubicTo( ox, oy, ix, iy, x, y );
+	tvg::Point pts[3] = { { ox, oy }, { ix, iy }, { x, y } };
+	if ( matches( tvg::PathCommand::CubicTo, pts, 3 ) ) return;
+	commands.push_back( tvg::PathCommand::CubicTo );
+	points.insert( points.end(), pts, pts + 3 );
+	version++;
 }
 
 void TvgRenderPath::close() {
-	tvgShape->close();
+	if ( matches( tvg::PathCommand::Close, nullptr, 0 ) ) return;
+	commands.push_back( tvg::PathCommand::Close );
+	version++;
+}
+
+bool TvgRenderPath::computeBounds( const rive::Mat2D& transform, rive::AABB& bounds ) {
+	build();
+	if ( points.empty() ) return false;
+
+	// Under scales and quarter turns the local box maps exactly to the
+	// transformed one, so only its corners are transformed. Other rotations
+	// would inflate the box and transform every point instead.
+	bool aligned = ( transform[1] == 0 && transform[2] == 0 ) || ( transform[0] == 0 && transform[3] == 0 );
+	if ( aligned ) {
+		float minX = points[0].x, minY = points[0].y, maxX = minX, maxY = minY;
+		for ( const tvg::Point& p : points ) {
+			minX = std::min( minX, p.x );
+			minY = std::min( minY, p.y );
+			maxX = std::max( maxX, p.x );
+			maxY = std::max( maxY, p.y );
+		}
+		tvg::Point a = transformCoord( { minX, minY }, transform );
+		tvg::Point b = transformCoord( { maxX, maxY }, transform );
+		bounds = rive::AABB( std::min( a.x, b.x ), std::min( a.y, b.y ), std::max( a.x, b.x ), std::max( a.y, b.y ) );
+		return true;
+	}
+
+	bounds = rive::AABB( 1e30f, 1e30f, -1e30f, -1e30f );
+	for ( const tvg::Point& pt : points ) {
+		tvg::Point p = transformCoord( pt, transform );
+		bounds.minX = std::min( bounds.minX, p.x );
+		bounds.minY = std::min( bounds.minY, p.y );
+		bounds.maxX = std::max( bounds.maxX, p.x );
+		bounds.maxY = std::max( bounds.maxY, p.y );
+	}
+	return true;
+}
+
+// Miter joins reach out up to the miter limit, ThorVG's default is 4. Other
+// joins and square caps stay within half the width times sqrt(2).
+static const float miterReach = 4.0f;
+static const float joinReach = 1.4143f;
+
+bool TvgRenderPath::computeDrawBounds( const rive::Mat2D& transform, const TvgPaint& paint, rive::AABB& bounds ) {
+	if ( !computeBounds( transform, bounds ) ) return false;
+	if ( paint.style == rive::RenderPaintStyle::stroke ) {
+		float scale = std::max( std::sqrt( transform[0] * transform[0] + transform[1] * transform[1] ),
+			std::sqrt( transform[2] * transform[2] + transform[3] * transform[3] ) );
+		float reach = paint.join == tvg::StrokeJoin::Miter ? miterReach : joinReach;
+		float pad = paint.thickness * 0.5f * reach * scale;
+		bounds = rive::AABB( bounds.minX - pad, bounds.minY - pad, bounds.maxX + pad, bounds.maxY + pad );
+	}
+	return true;
+}
+
+bool TvgRenderPath::computeRect( const rive::Mat2D& transform, rive::AABB& rect ) {
+	// Scales and quarter turns keep rectangles axis aligned
+	bool aligned = ( transform[1] == 0 && transform[2] == 0 ) || ( transform[0] == 0 && transform[3] == 0 );
+	if ( !aligned ) return false;
+
+	build();
+	const tvg::PathCommand* cmds = commands.data();
+	const tvg::Point* pts = points.data();
+	uint32_t cmdCnt = (uint32_t)commands.size();
+	uint32_t ptsCnt = (uint32_t)points.size();
+
+	// A move and three lines, optionally a fourth back to the start and a close
+	if ( cmdCnt < 4 || cmds[0] != tvg::PathCommand::MoveTo ) return false;
+	for ( uint32_t i = 1; i < cmdCnt; i++ ) {
+		bool line = cmds[i] == tvg::PathCommand::LineTo && i <= 4;
+		bool close = cmds[i] == tvg::PathCommand::Close && i == cmdCnt - 1;
+		if ( !line && !close ) return false;
+	}
+	if ( ptsCnt < 4 || ptsCnt > 5 ) return false;
+	if ( ptsCnt == 5 && ( pts[4].x != pts[0].x || pts[4].y != pts[0].y ) ) return false;
+
+	// Every edge is horizontal or vertical, alternating
+	for ( uint32_t i = 0; i < 4; i++ ) {
+		const tvg::Point& a = pts[i];
+		const tvg::Point& b = pts[( i + 1 ) % 4];
+		bool horizontal = a.y == b.y;
+		bool vertical = a.x == b.x;
+		if ( horizontal == vertical ) return false;
+		if ( horizontal != ( pts[0].y == pts[1].y ? i % 2 == 0 : i % 2 == 1 ) ) return false;
+	}
+	return computeBounds( transform, rect );
+}
+
+#ifndef NDEBUG
+TvgDrawSlot::~TvgDrawSlot() {
+	// A scene still holding the shape would draw freed memory, and free it
+	// again if it were cleared with free
+	auto frame = rendererFrame.lock();
+	assert( !frame || *frame != pushedFrame );
+}
+#endif
+
+TvgDrawSlot* TvgRenderPath::nextDrawSlot( uint32_t frame ) {
+	if ( drawFrame != frame ) {
+		// The last frame's shapes left their scene when this one began. A
+		// frame that drew the path unusually often doesn't keep its extras.
+		if ( drawSlots.size() > maxDrawSlots ) drawSlots.resize( maxDrawSlots );
+		drawFrame = frame;
+		drawIndex = 0;
+	}
+	if ( drawIndex == drawSlots.size() ) {
+		drawSlots.emplace_back( new TvgDrawSlot() );
+		drawSlots.back()->shape = tvg::Shape::gen();
+	}
+	return drawSlots[drawIndex++].get();
 }
 
 void TvgRenderPaint::style( rive::RenderPaintStyle style ) {
@@ -132,7 +302,47 @@ void TvgRenderPaint::completeGradient() {
 }
 
 void TvgRenderPaint::blendMode( rive::BlendMode value ) {
-
+	m_Paint.blendMode = value;
+	switch ( value ) {
+		case rive::BlendMode::screen:
+			m_Paint.blend = tvg::BlendMethod::Screen;
+			break;
+		case rive::BlendMode::overlay:
+			m_Paint.blend = tvg::BlendMethod::Overlay;
+			break;
+		case rive::BlendMode::darken:
+			m_Paint.blend = tvg::BlendMethod::Darken;
+			break;
+		case rive::BlendMode::lighten:
+			m_Paint.blend = tvg::BlendMethod::Lighten;
+			break;
+		case rive::BlendMode::colorDodge:
+			m_Paint.blend = tvg::BlendMethod::ColorDodge;
+			break;
+		case rive::BlendMode::colorBurn:
+			m_Paint.blend = tvg::BlendMethod::ColorBurn;
+			break;
+		case rive::BlendMode::hardLight:
+			m_Paint.blend = tvg::BlendMethod::HardLight;
+			break;
+		case rive::BlendMode::softLight:
+			m_Paint.blend = tvg::BlendMethod::SoftLight;
+			break;
+		case rive::BlendMode::difference:
+			m_Paint.blend = tvg::BlendMethod::Difference;
+			break;
+		case rive::BlendMode::exclusion:
+			m_Paint.blend = tvg::BlendMethod::Exclusion;
+			break;
+		case rive::BlendMode::multiply:
+			m_Paint.blend = tvg::BlendMethod::Multiply;
+			break;
+		default:
+			// srcOver, and the hue, saturation, color and luminosity modes
+			// ThorVG has no equivalent for
+			m_Paint.blend = tvg::BlendMethod::Normal;
+			break;
+	}
 }
 
 void TvgRadialGradientBuilder::make( TvgPaint* paint ) {
@@ -191,12 +401,158 @@ void RiveRenderer::transform( const rive::Mat2D& transform ) {
 	m_Transform = m_Transform * transform;
 }
 
+static std::atomic<uint32_t> gFrameCounter( 0 );
+
+// Scenes only ever hold paints owned elsewhere, by the draw slots of paths
+// or the renderer's transient pool, and are always emptied with clear( false ).
+// What is pushed is lent to the scene rather than handed over.
+static void lend( tvg::Scene* scene, tvg::Paint* paint ) {
+	scene->push( std::unique_ptr<tvg::Paint>( paint ) );
+}
+
+// Frame numbers are unique across renderers so paths can tell frames apart,
+// including those of a renderer that never begins one
+RiveRenderer::RiveRenderer( tvg::Scene* scene ) : m_Scene( scene ), m_Frame( ++gFrameCounter ) {
+#ifndef NDEBUG
+	m_LiveFrame = std::make_shared<uint32_t>( m_Frame );
+#endif
+}
+
+RiveRenderer::~RiveRenderer() {
+	// The scene outlives us but must not free the shapes our paths own. The
+	// pool's scenes are emptied before they are freed with it.
+	m_Scene->clear( false );
+	for ( auto& scene : m_Transient ) scene->clear( false );
+}
+
+void RiveRenderer::beginFrame() {
+	m_Scene->clear( false );
+	for ( size_t i = 0; i < m_TransientUsed; i++ ) m_Transient[i]->clear( false );
+	m_TransientUsed = 0;
+	m_Clip = TvgClip();
+	m_BgClip = TvgClip();
+	m_BgScene = nullptr;
+	m_Layer = TvgBlendLayer();
+	m_Frame = ++gFrameCounter;
+#ifndef NDEBUG
+	*m_LiveFrame = m_Frame;
+#endif
+}
+
+enum class ClipTest {
+	None,		// no clip, or not a rectangle
+	Inside,		// the draw is entirely inside the clip rectangle
+	Outside,	// the draw is entirely outside it
+	Partial
+};
+
+static ClipTest testRect( const TvgClip& clip, const rive::AABB& bounds ) {
+	if ( !clip.path || !clip.isRect ) return ClipTest::None;
+	const rive::AABB& r = clip.rect;
+	if ( bounds.minX >= r.minX && bounds.minY >= r.minY && bounds.maxX <= r.maxX && bounds.maxY <= r.maxY ) return ClipTest::Inside;
+	if ( bounds.maxX <= r.minX || bounds.maxY <= r.minY || bounds.minX >= r.maxX || bounds.minY >= r.maxY ) return ClipTest::Outside;
+	return ClipTest::Partial;
+}
+
+static std::unique_ptr<tvg::Shape> clipMask( const TvgClip& clip ) {
+	if ( clip.isRect ) {
+		// Rectangles are rebuilt in canvas space, far cheaper than a copy of the path
+		auto rect = tvg::Shape::gen();
+		rect->appendRect( clip.rect.minX, clip.rect.minY, clip.rect.maxX - clip.rect.minX, clip.rect.maxY - clip.rect.minY, 0, 0 );
+		rect->fill( 255, 255, 255, 255 );
+		return rect;
+	}
+	auto mask = tvg::Shape::gen();
+	clip.path->toShape( mask.get() );
+	mask->fill( 255, 255, 255, 255 );
+	mask->transform( clip.transform );
+	return mask;
+}
+
+tvg::Scene* RiveRenderer::transientScene() {
+	if ( m_TransientUsed == m_Transient.size() ) m_Transient.push_back( tvg::Scene::gen() );
+	tvg::Scene* scene = m_Transient[m_TransientUsed++].get();
+	// Undo whatever the scene was used for last frame
+	scene->composite( nullptr, tvg::CompositeMethod::None );
+	scene->blend( tvg::BlendMethod::Normal );
+	return scene;
+}
+
+// Antialiased edges reach into the next pixel, so draws closer than that
+// count as overlapping
+static bool overlaps( const rive::AABB& a, const rive::AABB& b ) {
+	return a.minX < b.maxX + 1 && b.minX < a.maxX + 1 && a.minY < b.maxY + 1 && b.minY < a.maxY + 1;
+}
+
+// Past this many draws a layer isn't worth the overlap tests
+static const size_t maxLayerDraws = 32;
+
+tvg::Scene* RiveRenderer::blendLayer( tvg::Scene* parent, tvg::BlendMethod method, const rive::AABB* bounds ) {
+	// The open layer can take the draw while it is still the last thing in
+	// the parent, and the draw doesn't overlap anything already in it
+	bool reuse = m_Layer.scene && m_Layer.parent == parent && m_Layer.method == method &&
+		m_Layer.bounds.size() < maxLayerDraws;
+	if ( reuse && bounds ) {
+		for ( const auto& other : m_Layer.bounds ) {
+			if ( overlaps( other, *bounds ) ) {
+				reuse = false;
+				break;
+			}
+		}
+	}
+	if ( !reuse ) {
+		// ThorVG composites the scene through an offscreen buffer from its
+		// own pool, covering only the scene's bounds
+		tvg::Scene* scene = transientScene();
+		scene->blend( method );
+		lend( parent, scene );
+		m_Layer.scene = scene;
+		m_Layer.parent = parent;
+		m_Layer.method = method;
+		m_Layer.bounds.clear();
+	}
+	if ( bounds ) m_Layer.bounds.push_back( *bounds );
+	return m_Layer.scene;
+}
+
 void RiveRenderer::drawPath( rive::RenderPath* path, rive::RenderPaint* paint ) {
-	auto tvgShape = static_cast<TvgRenderPath*>( path )->tvgShape.get();
+	auto renderPath = static_cast<TvgRenderPath*>( path );
 	auto tvgPaint = static_cast<TvgRenderPaint*>( paint )->paint();
+	renderPath->build();
+
+	// Rectangular clips are resolved against the draw's bounds first. Draws
+	// entirely outside are dropped and draws entirely inside need no mask.
+	// Blended draws need their bounds too, to keep overlapping draws in
+	// separate layers.
+	ClipTest bgTest = ClipTest::None;
+	ClipTest test = ClipTest::None;
+	bool blended = tvgPaint->blend != tvg::BlendMethod::Normal;
+	rive::AABB bounds;
+	bool hasBounds = false;
+	if ( blended || ( m_BgClip.path && m_BgClip.isRect ) || ( m_Clip.path && m_Clip.isRect ) ) {
+		hasBounds = renderPath->computeDrawBounds( m_Transform, *tvgPaint, bounds );
+		if ( hasBounds ) {
+			bgTest = testRect( m_BgClip, bounds );
+			test = testRect( m_Clip, bounds );
+		}
+		if ( bgTest == ClipTest::Outside || test == ClipTest::Outside ) {
+			m_Clip = TvgClip();
+			return;
+		}
+	}
 
-	/* OPTIMIZE ME: Stroke / Fill Paints required to draw separately.
-		thorvg doesn't need to handle both, we can avoid one of them rendering... */
+	// Reuse the shape this path drew at the same point last frame. Its
+	// geometry is only copied when the path changed, so ThorVG keeps the
+	// prepared outline for static paths.
+	auto slot = renderPath->nextDrawSlot( m_Frame );
+	auto tvgShape = slot->shape.get();
+	if ( slot->version != renderPath->version ) {
+		renderPath->toShape( tvgShape );
+		slot->version = renderPath->version;
+	}
+
+	/* Fill and stroke draws of the same path use separate slots, so each only
+		sets the style it draws and clears the other. */
 
 	if ( tvgPaint->style == rive::RenderPaintStyle::fill ) {
 		if ( !tvgPaint->isGradient )
@@ -204,8 +560,10 @@ void RiveRenderer::drawPath( rive::RenderPath* path, rive::RenderPaint* paint )
 		else {
 			tvgShape->fill(std::unique_ptr<tvg::Fill>( tvgPaint->gradientFill->duplicate() ) );
 		}
+		if ( tvgShape->strokeWidth() > 0 ) tvgShape->stroke( 0.0f );
 	}
 	else if ( tvgPaint->style == rive::RenderPaintStyle::stroke ) {
+		tvgShape->fill( 0, 0, 0, 0 );
 		tvgShape->stroke( tvgPaint->cap );
 		tvgShape->stroke( tvgPaint->join );
 		tvgShape->stroke( tvgPaint->thickness );
@@ -217,41 +575,66 @@ void RiveRenderer::drawPath( rive::RenderPath* path, rive::RenderPaint* paint )
 		}
 	}
 
-	if ( m_ClipPath ) {
-		m_ClipPath->fill( 255, 255, 255, 255 );
-		tvgShape->composite(std::unique_ptr<tvg::Shape>( static_cast<tvg::Shape*>( m_ClipPath->duplicate() ) ), tvg::CompositeMethod::ClipPath );
-		m_ClipPath = nullptr;
+	if ( m_Clip.path && test != ClipTest::Inside ) {
+		tvgShape->composite( clipMask( m_Clip ), tvg::CompositeMethod::ClipPath );
+		slot->clipped = true;
+	}
+	else if ( slot->clipped ) {
+		tvgShape->composite( nullptr, tvg::CompositeMethod::None );
+		slot->clipped = false;
+	}
+	m_Clip = TvgClip();
+
+	// Setting an unchanged transform would still invalidate the shape
+	tvg::Matrix m = { m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1 };
+	if ( !slot->hasTransform || memcmp( &m, &slot->transform, sizeof( m ) ) != 0 ) {
+		tvgShape->transform( m );
+		slot->transform = m;
+		slot->hasTransform = true;
 	}
 
-	tvgShape->transform( { m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1 } );
+	tvg::Scene* parent = m_Scene;
+	if ( m_BgClip.path && bgTest != ClipTest::Inside ) {
+		// Consecutive draws share one masked scene instead of a mask each
+		if ( !m_BgScene ) {
+			m_BgScene = transientScene();
+			m_BgScene->composite( clipMask( m_BgClip ), tvg::CompositeMethod::ClipPath );
+			lend( m_Scene, m_BgScene );
+		}
+		parent = m_BgScene;
+	}
+	else {
+		// Anything drawn after this must not go under it
+		m_BgScene = nullptr;
+	}
 
-	if ( m_BgClipPath ) {
-		m_BgClipPath->fill( 255, 255, 255, 255 );
-		auto scene = tvg::Scene::gen();
-		scene->push(std::unique_ptr<tvg::Paint>( tvgShape->duplicate() ) );
-		scene->composite(std::unique_ptr<tvg::Shape>( static_cast<tvg::Shape*>( m_BgClipPath->duplicate() ) ), tvg::CompositeMethod::ClipPath );
-		m_Scene->push( move( scene ) );
+	if ( blended ) {
+		parent = blendLayer( parent, tvgPaint->blend, hasBounds ? &bounds : nullptr );
 	}
-	else
-		m_Scene->push( std::unique_ptr<tvg::Paint>( tvgShape->duplicate() ) );
+	else {
+		m_Layer.scene = nullptr;
+	}
+	lend( parent, tvgShape );
+#ifndef NDEBUG
+	slot->pushedFrame = m_Frame;
+	slot->rendererFrame = m_LiveFrame;
+#endif
 }
 
 void RiveRenderer::clipPath( rive::RenderPath* path ) {
 	//Note: ClipPath transform matrix is calculated by transfrom matrix in addRenderPath function
-	if ( !m_BgClipPath ) {
-		m_BgClipPath = static_cast<TvgRenderPath*>( path )->tvgShape.get();
-		m_BgClipPath->transform( { m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1 } );
-	}
-	else {
-		m_ClipPath = static_cast<TvgRenderPath*>( path )->tvgShape.get();
-		m_ClipPath->transform( { m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1 } );
+	auto renderPath = static_cast<TvgRenderPath*>( path );
+	renderPath->build();
+	TvgClip& clip = m_BgClip.path ? m_Clip : m_BgClip;
+	clip.path = renderPath;
+	clip.isRect = renderPath->computeRect( m_Transform, clip.rect );
+	if ( !clip.isRect ) {
+		clip.transform = { m_Transform[0], m_Transform[2], m_Transform[4], m_Transform[1], m_Transform[3], m_Transform[5], 0, 0, 1 };
 	}
 }
 
 void RiveRenderer::resetClipPath() {
-	if (m_ClipPath) {
-		m_ClipPath->reset();
-	}
+	m_Clip = TvgClip();
 }
 
 namespace rive {
@@ -11,6 +11,8 @@
 // Rive
 #include "renderer.hpp"
 // Other
+#include <cstdint>
+#include <memory>
 #include <vector>
 #include <stack>
 
@@ -21,15 +23,73 @@ struct TvgPaint {
 	tvg::StrokeJoin join = tvg::StrokeJoin::Bevel;
 	tvg::StrokeCap  cap = tvg::StrokeCap::Butt;
 	rive::RenderPaintStyle style = rive::RenderPaintStyle::fill;
+	rive::BlendMode blendMode = rive::BlendMode::srcOver;
+	// blendMode as ThorVG applies it
+	tvg::BlendMethod blend = tvg::BlendMethod::Normal;
 	bool isGradient = false;
 };
 
+/**
+ * @brief A shape drawn from a path in one frame. Kept between frames so ThorVG
+ * can reuse its prepared geometry when neither the path nor the draw changed.
+ * The slot owns the shape; the scene it is pushed to only borrows it until
+ * the renderer's next beginFrame().
+ */
+struct TvgDrawSlot {
+	std::unique_ptr<tvg::Shape> shape;
+	// The path version the shape's geometry was copied from
+	uint32_t version = UINT32_MAX;
+	tvg::Matrix transform;
+	bool hasTransform = false;
+	bool clipped = false;
+#ifndef NDEBUG
+	// The frame the shape was last pushed in and the current frame of the
+	// renderer that pushed it, to catch a slot freed while still in a scene
+	uint32_t pushedFrame = 0;
+	std::weak_ptr<const uint32_t> rendererFrame;
+
+	~TvgDrawSlot();
+#endif
+};
+
+/**
+ * @brief A rive path that keeps its own commands and points, copied into
+ * ThorVG shapes only when drawn or used as a clip.
+ * Rive rebuilds paths with reset() followed by the same commands, even when
+ * nothing changed. Rebuilt commands are compared against the stored path as
+ * they arrive and the buffers are only truncated from the first command that
+ * differs, so unchanged paths keep their geometry and version. The buffers
+ * keep their capacity across rebuilds, so animated paths don't reallocate.
+ */
 struct TvgRenderPath : public rive::RenderPath {
-	std::unique_ptr<tvg::Shape> tvgShape;
+	std::vector<tvg::PathCommand> commands;
+	std::vector<tvg::Point> points;
+	tvg::FillRule tvgFillRule = tvg::FillRule::Winding;
 
-	TvgRenderPath() : tvgShape( tvg::Shape::gen() ) {}
+	// Incremented whenever the geometry or fill rule changes
+	uint32_t version = 0;
+
+	// Shapes drawn from this path, reused frame to frame in draw order. A
+	// frame gets as many as it draws, and the next one drawing the path
+	// frees all but maxDrawSlots of them.
+	static const size_t maxDrawSlots = 64;
+	std::vector<std::unique_ptr<TvgDrawSlot>> drawSlots;
+	uint32_t drawFrame = 0;
+	size_t drawIndex = 0;
+
+	/**
+	 * Finish a rebuild started by reset(). Must be called before commands
+	 * or points are read.
+	 */
+	void build();
+
+	/**
+	 * Replace a shape's path and fill rule with this path's. ThorVG keeps
+	 * the shape's storage, so shapes that are refilled every frame don't
+	 * regrow it either.
+	 */
+	void toShape( tvg::Shape* shape ) const;
 
-	void buildShape();
 	void reset() override;
 	void addRenderPath( rive::RenderPath* path, const rive::Mat2D& transform ) override;
 	void fillRule( rive::FillRule value ) override;
@@ -37,6 +97,41 @@ struct TvgRenderPath : public rive::RenderPath {
 	void lineTo( float x, float y ) override;
 	void cubicTo( float ox, float oy, float ix, float iy, float x, float y ) override;
 	void close() override;
+
+	/**
+	 * @return The draw slot for the next draw of this path in a frame
+	 */
+	TvgDrawSlot* nextDrawSlot( uint32_t frame );
+
+	/**
+	 * Bounds of the path's points under a transform. Curves stay inside
+	 * their control points, so the path is always within them.
+	 * @return false if the path is empty
+	 */
+	bool computeBounds( const rive::Mat2D& transform, rive::AABB& bounds );
+
+	/**
+	 * Bounds of what drawing the path with a paint covers, the path's bounds
+	 * grown by as far as the paint's stroke can reach under the transform
+	 * @return false if the path is empty
+	 */
+	bool computeDrawBounds( const rive::Mat2D& transform, const TvgPaint& paint, rive::AABB& bounds );
+
+	/**
+	 * Check whether the path is a rectangle that stays axis aligned under a
+	 * transform, as artboard and layout clips usually are
+	 * @param rect Set to the transformed rectangle
+	 */
+	bool computeRect( const rive::Mat2D& transform, rive::AABB& rect );
+
+private:
+	bool matches( tvg::PathCommand cmd, const tvg::Point* pts, uint32_t ptsCnt );
+	void diverge();
+
+	// How much of the stored path a rebuild has matched so far
+	uint32_t m_CmdCursor = 0;
+	uint32_t m_PtsCursor = 0;
+	bool m_Diverged = true;
 };
 
 struct TvgGradientStop {
@@ -90,20 +185,78 @@ public:
 	void completeGradient() override;
 };
 
+/**
+ * @brief A clip waiting to be applied. Axis aligned rectangles are kept as
+ * their bounds so draws can be tested against them without a mask.
+ */
+struct TvgClip {
+	TvgRenderPath* path = nullptr;
+	bool isRect = false;
+	rive::AABB rect;
+	// The transform the path is masked with, unless it is a rectangle
+	tvg::Matrix transform;
+};
+
+/**
+ * @brief Consecutive draws with the same blend mode, composited onto what is
+ * below as one layer. Draws only join while they don't overlap each other,
+ * where blending them one at a time and as a group give the same result.
+ */
+struct TvgBlendLayer {
+	tvg::Scene* scene = nullptr;
+	// The scene the layer was pushed to
+	tvg::Scene* parent = nullptr;
+	tvg::BlendMethod method = tvg::BlendMethod::Normal;
+	std::vector<rive::AABB> bounds;
+};
+
 /**
 	* @brief A renderer to render rive objects to ThorVG
 	*/
 class RiveRenderer : public rive::Renderer {
 private:
 	tvg::Scene* m_Scene = nullptr;
-	tvg::Shape* m_ClipPath = nullptr;
-	tvg::Shape* m_BgClipPath = nullptr;
+	uint32_t m_Frame = 0;
+	// Wrapper scenes, kept from frame to frame and handed out in order by
+	// transientScene(). Shapes pushed into scenes are owned by their paths,
+	// so scenes are always cleared without freeing.
+	std::vector<std::unique_ptr<tvg::Scene>> m_Transient;
+	size_t m_TransientUsed = 0;
+#ifndef NDEBUG
+	// m_Frame, for draw slots to check they aren't freed mid frame
+	std::shared_ptr<uint32_t> m_LiveFrame;
+#endif
+	TvgBlendLayer m_Layer;
+	// The first clip of a frame applies to every draw after it, later ones
+	// only to the next draw
+	TvgClip m_Clip;
+	TvgClip m_BgClip;
+	// The wrapper scene masked by the background clip that consecutive
+	// draws are added to
+	tvg::Scene* m_BgScene = nullptr;
 	rive::Mat2D m_Transform;
 	std::stack<rive::Mat2D> m_SavedTransforms;
 	rive::Mat2D m_DeriveTransform;
 
+	tvg::Scene* transientScene();
+	tvg::Scene* blendLayer( tvg::Scene* parent, tvg::BlendMethod method, const rive::AABB* bounds );
+
 public:
-	RiveRenderer( tvg::Scene* scene ) : m_Scene(scene) {}
+	RiveRenderer( tvg::Scene* scene );
+
+	/**
+	 * Empties the scene. Paths whose shapes are in the scene must outlive
+	 * the renderer or its next beginFrame().
+	 */
+	~RiveRenderer();
+
+	/**
+	 * Empty the scene ready for the next frame. Use instead of clearing the
+	 * scene directly, the shapes in it are owned by their paths. Required
+	 * before every frame but the first: draws made without it are all part
+	 * of one frame, their shapes and the scene keep growing.
+	 */
+	void beginFrame();
 	void save() override;
 	void restore() override;
 	void transform( const rive::Mat2D& transform ) override;
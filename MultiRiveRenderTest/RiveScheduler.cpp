@@ -0,0 +1,68 @@
+#include "RiveScheduler.h"
+#include <algorithm>
+
+void RiveScheduler::add(Rive* rive, Priority priority) {
+    _entries.push_back({ rive, priority });
+}
+
+void RiveScheduler::remove(Rive* rive) {
+    _entries.erase(std::remove_if(_entries.begin(), _entries.end(),
+        [rive](const Entry& e) { return e.rive == rive; }), _entries.end());
+}
+
+void RiveScheduler::priority(Rive* rive, Priority priority) {
+    for (auto& e : _entries) {
+        if (e.rive == rive) e.priority = priority;
+    }
+}
+
+int RiveScheduler::divisor(const Entry& entry) const {
+    if (entry.priority == High || _level == 0) return 1;
+
+    // Each level halves the rate once more, starting with low priority and
+    // small instances; never slower than quarter rate
+    rive::AABB b = entry.rive->bounds();
+    bool small = (b.maxX - b.minX) * (b.maxY - b.minY) < _options.smallArea;
+    int shift = _level - (int)entry.priority + (small ? 1 : 0);
+    return 1 << std::max(0, std::min(shift, 2));
+}
+
+void RiveScheduler::update(double dt, tvg::SwCanvas* canvas) {
+    _skipped = 0;
+    for (size_t i = 0; i < _entries.size(); i++) {
+        const Entry& e = _entries[i];
+        int d = divisor(e);
+        // Offset by index so reduced rate instances don't all land on the same frame
+        if ((_frame + i) % d == 0) {
+            e.rive->update(dt, canvas);
+        }
+        else {
+            e.rive->skip(dt);
+            _skipped++;
+        }
+    }
+    _frame++;
+}
+
+void RiveScheduler::frameTime(double seconds) {
+    _smoothed = _smoothed == 0 ? seconds : _smoothed * 0.9 + seconds * 0.1;
+
+    if (_smoothed > _options.targetFrameTime * _options.degradeAbove) {
+        _underFrames = 0;
+        if (++_overFrames >= _options.framesToChange && _level < maxLevel) {
+            _level++;
+            _overFrames = 0;
+        }
+    }
+    else if (_smoothed < _options.targetFrameTime * _options.recoverBelow) {
+        _overFrames = 0;
+        if (++_underFrames >= _options.framesToChange * 2 && _level > 0) {
+            _level--;
+            _underFrames = 0;
+        }
+    }
+    else {
+        _overFrames = 0;
+        _underFrames = 0;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "Rive.h"
+#include <vector>
+
+/**
+ * @brief Updates Rive instances at reduced rates when frames run over budget.
+ *
+ * Each instance has a priority. While frame times stay within budget every
+ * instance is updated every frame. As measured frame time rises above the
+ * target the scheduler raises a pressure level, and low priority or small
+ * instances drop to half and then quarter rate, keeping their last drawn
+ * scene in between. The level falls again once frame times recover. Changes
+ * need several frames in a row on the same side of the thresholds, so the
+ * level does not flap.
+ */
+class RiveScheduler {
+public:
+    enum Priority {
+        Low = 0,
+        Normal = 1,
+        // Always updated every frame
+        High = 2
+    };
+
+    struct Options {
+        // The frame time to stay within, in seconds
+        double targetFrameTime = 1.0 / 60.0;
+        // Raise the level above this fraction of the target
+        double degradeAbove = 1.0;
+        // Lower the level below this fraction of the target
+        double recoverBelow = 0.75;
+        // Consecutive frames needed to raise the level; lowering takes twice as many
+        int framesToChange = 10;
+        // Instances whose on-canvas area is below this many pixels count as small
+        float smallArea = 128 * 128;
+    };
+
+    RiveScheduler() {}
+    RiveScheduler(const Options& options) : _options(options) {}
+
+    void add(Rive* rive, Priority priority = Normal);
+    void remove(Rive* rive);
+    void priority(Rive* rive, Priority priority);
+
+    /**
+     * Update the instances due this frame and skip the rest
+     */
+    void update(double dt, tvg::SwCanvas* canvas);
+
+    /**
+     * Report how long the last frame took, including rasterization
+     * @param seconds The measured frame time
+     */
+    void frameTime(double seconds);
+
+    /**
+     * @return The current pressure level, 0 when everything runs at full rate
+     */
+    int level() const { return _level; }
+
+    /**
+     * @return The number of instances skipped in the last update
+     */
+    int skipped() const { return _skipped; }
+
+    static const int maxLevel = 3;
+
+protected:
+    struct Entry {
+        Rive* rive;
+        Priority priority;
+    };
+
+    int divisor(const Entry& entry) const;
+
+    Options _options;
+    std::vector<Entry> _entries;
+    double _smoothed = 0;
+    int _level = 0;
+    int _overFrames = 0;
+    int _underFrames = 0;
+    unsigned _frame = 0;
+    int _skipped = 0;
+};
@@ -0,0 +1,36 @@
+#include "RiveSnapshot.h"
+#include "animation/state_machine_bool.hpp"
+#include "animation/state_machine_input_instance.hpp"
+#include "animation/state_machine_number.hpp"
+
+RiveSnapshot::RiveSnapshot(const Rive& prototype) :
+    _file(prototype._file),
+    _stateMachineIndex(prototype._stateMachineIndex) {
+    if (prototype._artboard) _artboard = prototype._artboard->instance();
+    if (prototype._stateMachine) {
+        _inputValues.resize(prototype._stateMachine->inputCount());
+        for (size_t i = 0; i < _inputValues.size(); i++) {
+            auto inputInstance = prototype._stateMachine->input(i);
+            if (inputInstance->input()->is<rive::StateMachineNumber>()) {
+                _inputValues[i] = static_cast<rive::SMINumber*>(inputInstance)->value();
+            }
+            else if (inputInstance->input()->is<rive::StateMachineBool>()) {
+                _inputValues[i] = static_cast<rive::SMIBool*>(inputInstance)->value() ? 1.0f : 0.0f;
+            }
+        }
+    }
+    if (prototype._animation) _animation.reset(new rive::LinearAnimationInstance(*prototype._animation));
+    if (prototype._baked) {
+        _baked = prototype._baked->sharedAnimation();
+        _bakedTime = prototype._baked->time();
+    }
+}
+
+RiveSnapshot::~RiveSnapshot() {
+    // Instances don't own the animations they share with the file
+    delete _artboard;
+}
+
+std::unique_ptr<Rive> RiveSnapshot::clone(tvg::SwCanvas* canvas) const {
+    return std::unique_ptr<Rive>(new Rive(*this, canvas));
+}
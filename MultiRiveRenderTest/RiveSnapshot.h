@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Rive.h"
+#include <memory>
+#include <vector>
+
+/**
+ * @brief The initialized state of a Rive instance, captured once so more
+ * instances can be started from it without importing the file again.
+ *
+ * Importing parses the whole file and builds every object. A snapshot keeps
+ * the imported file alive and an instance of the prototype's artboard, which
+ * rive clones object by object and relinks by id; animations and state
+ * machine definitions stay shared with the file. Clones copy that artboard
+ * and the prototype's animation time, state machine choice, number and bool
+ * input values, and baked animation.
+ *
+ * rive doesn't expose which state each state machine layer is in, so a
+ * clone's state machine starts its layers from their entry states with the
+ * captured inputs, and transitions from there on its first advance. Pending
+ * triggers aren't captured.
+ *
+ * A snapshot is not changed by cloning and may outlive its prototype. Clones
+ * keep the file alive, so they may outlive the snapshot.
+ */
+class RiveSnapshot {
+public:
+    /**
+     * Capture a prototype as it is now, reset or mid animation
+     */
+    RiveSnapshot(const Rive& prototype);
+    ~RiveSnapshot();
+
+    /**
+     * Start a new instance in the captured state, its scene pushed onto a
+     * canvas like a Rive constructed from the file
+     */
+    std::unique_ptr<Rive> clone(tvg::SwCanvas* canvas) const;
+
+protected:
+    friend class Rive;
+
+    std::shared_ptr<rive::File> _file;
+    rive::Artboard* _artboard = nullptr;
+    // Copied into each clone, it only refers to the shared animation
+    std::unique_ptr<rive::LinearAnimationInstance> _animation;
+    int _stateMachineIndex = -1;
+    // By input index, bools as 0 or 1. Triggers are left at 0.
+    std::vector<float> _inputValues;
+    std::shared_ptr<const BakedAnimation> _baked;
+    float _bakedTime = 0;
+};
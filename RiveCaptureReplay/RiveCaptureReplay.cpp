@@ -0,0 +1,112 @@
+// RiveCaptureReplay.cpp : Replays a renderer capture into ThorVG and reports rasterization timing.
+//
+// Usage: RiveCaptureReplay <capture> [--loops 10] [--threads N] [--png last.png]
+//
+// --threads is ThorVG's thread count, by default the CPUs the process may use.
+//
+// Captures are written by MultiRiveRenderTest --capture. Replay doesn't touch
+// rive at all, so the timings only cover RiveRenderer, ThorVG and its rasterizer.
+
+#include "thorvg.h"
+#include "../MultiRiveRenderTest/CaptureFile.h"
+#include "../MultiRiveRenderTest/ImageWriter.h"
+#include "../common/TaskSystem.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[])
+{
+    std::string path;
+    std::string png;
+    int loops = 10;
+    int threads = -1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--loops" && hasValue) loops = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) threads = atoi(argv[++i]);
+        else if (arg == "--png" && hasValue) png = argv[++i];
+        else path = arg;
+    }
+    if (path.empty() || loops <= 0) {
+        std::cerr << "Usage: RiveCaptureReplay <capture> [--loops 10] [--threads N] [--png last.png]" << std::endl;
+        return 1;
+    }
+
+    // Replay itself is single threaded, the whole budget goes to ThorVG
+    if (threads < 0) threads = TaskSystem::availableCpus();
+    TaskSystem::Options taskOptions;
+    taskOptions.threads = std::max(1, threads);
+    taskOptions.rasterThreads = threads;
+    TaskSystem tasks(taskOptions);
+
+    // The reader's paths own ThorVG shapes, it must go before the engine does
+    CaptureReader reader;
+    if (!reader.load(path) || reader.frameCount() == 0) {
+        std::cerr << "Failed to load " << path << std::endl;
+        return 1;
+    }
+
+    int result = 0;
+    {
+        int width = reader.width();
+        int height = reader.height();
+        std::vector<uint32_t> buffer((size_t)width * height);
+        std::unique_ptr<tvg::SwCanvas> canvas = tvg::SwCanvas::gen();
+        canvas->target(buffer.data(), width, width, height, tvg::SwCanvas::ARGB8888);
+        std::unique_ptr<tvg::Scene> scene = tvg::Scene::gen();
+        canvas->push(scene.get());
+        RiveRenderer renderer(scene.get());
+
+        // Every frame is timed on its own, from replay to the end of sync
+        std::vector<double> times;
+        times.reserve((size_t)reader.frameCount() * loops);
+        for (int loop = 0; loop < loops; loop++) {
+            // Definitions are incremental, each loop starts over with new
+            // paths and paints. The scene mustn't hold the old shapes.
+            renderer.beginFrame();
+            reader.rewind();
+            while (true) {
+                auto start = std::chrono::steady_clock::now();
+                renderer.beginFrame();
+                if (!reader.replayNext(&renderer)) break;
+                canvas->update(scene.get());
+                tasks.raster(canvas.get());
+                auto end = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1000000.0);
+            }
+            if (reader.failed()) {
+                std::cerr << path << " has a corrupt frame" << std::endl;
+                result = 1;
+                break;
+            }
+        }
+
+        std::sort(times.begin(), times.end());
+        double total = 0;
+        for (double t : times) total += t;
+        if (!times.empty()) {
+            std::cout << reader.frameCount() << " frames x " << loops << " loops at " << width << "x" << height
+                << ", " << threads << " threads" << std::endl;
+            std::cout << "avg " << total / times.size() << "ms, min " << times.front()
+                << "ms, p99 " << times[std::min(times.size() - 1, times.size() * 99 / 100)]
+                << "ms, max " << times.back() << "ms" << std::endl;
+        }
+        tasks.printStats(std::cout);
+
+        if (!png.empty() && !writePng(png, buffer.data(), width, width, height)) {
+            std::cerr << "Failed to write " << png << std::endl;
+            result = 1;
+        }
+
+        // The shapes in the scene belong to the reader's paths
+        renderer.beginFrame();
+        canvas->clear(false);
+    }
+
+    return result;
+}
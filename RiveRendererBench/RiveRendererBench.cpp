@@ -0,0 +1,513 @@
+// RiveRendererBench.cpp : Microbenchmarks for the RiveRenderer hot paths.
+//
+// Usage: RiveRendererBench [--filter text] [--min-time 0.2] [--repeats 5] [--json results.json]
+//
+// Each benchmark is run for at least --min-time seconds per sample, and the
+// median and fastest of --repeats samples are reported per operation. Only the
+// renderer calls are measured; rasterization is left to ThorVG's update and
+// draw, which RiveCaptureReplay covers with real content. The pixel
+// conversions every output path goes through are measured per 1080p frame.
+// Animation is measured as advancing and applying the example file's first
+// animation on a set of artboards, from keyframes and from baked tracks.
+// Startup is measured per instance, importing the file against cloning a
+// snapshot, along with the cost of taking the snapshot.
+
+#include "thorvg.h"
+#include "../MultiRiveRenderTest/BakedAnimation.h"
+#include "../MultiRiveRenderTest/PixelConvert.h"
+#include "../MultiRiveRenderTest/RiveSnapshot.h"
+#include "../MultiRiveRenderTest/RiveRenderer.h"
+#include "../MultiRiveRenderTest/juiceriv.h"
+#include "animation/linear_animation_instance.hpp"
+#include "core/binary_reader.hpp"
+#include "file.hpp"
+#include "math/mat2d.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct BenchOptions {
+    std::string filter;
+    double minTime = 0.2;
+    int repeats = 5;
+    std::string json;
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, std::string>> params;
+    long long iterations = 0;
+    double nsPerOp = 0;
+    double minNsPerOp = 0;
+};
+
+/**
+ * @brief Runs benchmarks and collects their results.
+ * A benchmark is a function that performs an operation a given number of times.
+ */
+class BenchRunner {
+public:
+    typedef std::function<void(long long)> Body;
+    typedef std::vector<std::pair<std::string, std::string>> Params;
+
+    BenchRunner(const BenchOptions& options) : _options(options) {}
+
+    /**
+     * Run a benchmark unless it is filtered out
+     * @param name The benchmark's family, e.g. "drawPath"
+     * @param params Its parameters, appended to the name as key:value
+     * @param body Performs the operation the given number of times
+     */
+    void run(const std::string& name, const Params& params, const Body& body) {
+        std::string fullName = name;
+        for (auto& param : params) fullName += "/" + param.first + ":" + param.second;
+        if (!_options.filter.empty() && fullName.find(_options.filter) == std::string::npos) return;
+
+        // Grow the iteration count until one sample takes long enough to time
+        long long iterations = 1;
+        double seconds = time(body, iterations);
+        while (seconds < _options.minTime && iterations < (1LL << 40)) {
+            double scale = seconds > 0 ? _options.minTime / seconds * 1.2 : 10;
+            iterations = std::max(iterations + 1, (long long)(iterations * std::min(scale, 10.0)));
+            seconds = time(body, iterations);
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < _options.repeats; i++) {
+            samples.push_back(time(body, iterations) * 1e9 / iterations);
+        }
+        std::sort(samples.begin(), samples.end());
+
+        BenchResult result;
+        result.name = fullName;
+        result.params = params;
+        result.iterations = iterations;
+        result.nsPerOp = samples[samples.size() / 2];
+        result.minNsPerOp = samples.front();
+        _results.push_back(result);
+
+        std::cout << fullName;
+        for (size_t i = fullName.size(); i < 64; i++) std::cout << ' ';
+        std::cout << result.nsPerOp << " ns/op (min " << result.minNsPerOp << ", " << iterations << " iterations)" << std::endl;
+    }
+
+    bool writeJson(const std::string& path) const {
+        std::ofstream out(path);
+        if (!out) return false;
+        out << "{\n  \"minTime\": " << _options.minTime << ",\n  \"repeats\": " << _options.repeats << ",\n  \"benchmarks\": [\n";
+        for (size_t i = 0; i < _results.size(); i++) {
+            const auto& result = _results[i];
+            out << "    { \"name\": \"" << result.name << "\", \"params\": {";
+            for (size_t p = 0; p < result.params.size(); p++) {
+                out << (p ? ", " : " ") << "\"" << result.params[p].first << "\": \"" << result.params[p].second << "\"";
+            }
+            out << (result.params.empty() ? "}" : " }") << ", \"iterations\": " << result.iterations
+                << ", \"nsPerOp\": " << result.nsPerOp << ", \"minNsPerOp\": " << result.minNsPerOp << " }"
+                << (i + 1 < _results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return (bool)out;
+    }
+
+protected:
+    static double time(const Body& body, long long iterations) {
+        auto start = std::chrono::steady_clock::now();
+        body(iterations);
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count() / 1e9;
+    }
+
+    BenchOptions _options;
+    std::vector<BenchResult> _results;
+};
+
+/**
+ * Build a closed blob of cubics with roughly the given number of points
+ */
+static void buildBlob(TvgRenderPath& path, int points) {
+    int cubics = std::max(1, (points - 1) / 3);
+    const float radius = 100;
+    constexpr float pi = 3.14159265358979f;
+    path.reset();
+    path.moveTo(radius, 0);
+    for (int i = 0; i < cubics; i++) {
+        float a0 = 2 * pi * i / cubics;
+        float a1 = 2 * pi * (i + 1) / cubics;
+        float r = radius * (i % 2 ? 1.0f : 0.9f);
+        path.cubicTo(r * cosf(a0 + (a1 - a0) / 3), r * sinf(a0 + (a1 - a0) / 3),
+            r * cosf(a1 - (a1 - a0) / 3), r * sinf(a1 - (a1 - a0) / 3),
+            radius * cosf(a1), radius * sinf(a1));
+    }
+    path.close();
+    path.build();
+}
+
+static void buildRect(TvgRenderPath& path, float x, float y, float w, float h) {
+    path.reset();
+    path.moveTo(x, y);
+    path.lineTo(x + w, y);
+    path.lineTo(x + w, y + h);
+    path.lineTo(x, y + h);
+    path.close();
+    path.build();
+}
+
+static rive::Mat2D makeTransform(const std::string& type, float offset) {
+    rive::Mat2D m;
+    if (type == "translate") {
+        m[4] = 10 + offset;
+        m[5] = 20;
+    }
+    else if (type == "affine") {
+        rive::Mat2D::fromRotation(m, 0.3f + offset * 0.001f);
+        m[0] *= 1.5f;
+        m[3] *= 0.75f;
+        m[4] = 10;
+        m[5] = 20;
+    }
+    else if (offset != 0) {
+        // Identity can't change, animated identity falls back to a tiny shift
+        m[4] = offset * 0.001f;
+    }
+    return m;
+}
+
+static void benchAddRenderPath(BenchRunner& runner) {
+    for (int points : { 16, 256, 4096 }) {
+        for (const char* type : { "identity", "translate", "affine" }) {
+            // Static rebuilds repeat last frame's commands and hit the compare,
+            // animated ones change every frame and rewrite the points
+            for (bool animated : { false, true }) {
+                TvgRenderPath source;
+                buildBlob(source, points);
+                TvgRenderPath target;
+                rive::Mat2D fixed = makeTransform(type, 0);
+                runner.run("addRenderPath", { { "points", std::to_string(points) }, { "transform", type }, { "animated", animated ? "1" : "0" } },
+                    [&](long long iterations) {
+                        for (long long i = 0; i < iterations; i++) {
+                            target.reset();
+                            target.addRenderPath(&source, animated ? makeTransform(type, (float)(i & 1)) : fixed);
+                            target.build();
+                        }
+                    });
+            }
+        }
+    }
+}
+
+static void setPaint(TvgRenderPaint& paint, const std::string& style, const std::string& fill) {
+    paint.style(style == "stroke" ? rive::RenderPaintStyle::stroke : rive::RenderPaintStyle::fill);
+    paint.thickness(4);
+    paint.join(rive::StrokeJoin::round);
+    paint.cap(rive::StrokeCap::round);
+    if (fill == "solid") {
+        paint.color(0xff3080c0);
+        return;
+    }
+    if (fill == "linear") paint.linearGradient(-100, 0, 100, 0);
+    else paint.radialGradient(0, 0, 100, 0);
+    paint.addStop(0xffff0000, 0);
+    paint.addStop(0xff0000ff, 1);
+    paint.completeGradient();
+}
+
+static void benchDrawPath(BenchRunner& runner) {
+    TvgRenderPath path;
+    buildBlob(path, 64);
+    TvgRenderPath clip;
+    buildBlob(clip, 16);
+    TvgRenderPath rectClip;
+    buildRect(rectClip, -50, -50, 100, 100);
+    TvgRenderPath containingClip;
+    buildRect(containingClip, -200, -200, 400, 400);
+
+    for (const char* style : { "fill", "stroke" }) {
+        for (const char* fill : { "solid", "linear", "radial" }) {
+            // The renderer treats its first clip as the background clip for
+            // everything after it, later clips apply to the next draw only.
+            // Rectangles cut through the path, or contain it entirely.
+            for (const char* clipKind : { "none", "background", "nested", "backgroundRect", "nestedRect", "containingRect" }) {
+                TvgRenderPaint paint;
+                setPaint(paint, style, fill);
+                auto scene = tvg::Scene::gen();
+                std::string kind = clipKind;
+                runner.run("drawPath", { { "style", style }, { "paint", fill }, { "clip", clipKind } },
+                    [&](long long iterations) {
+                        RiveRenderer renderer(scene.get());
+                        TvgRenderPath* clipPath = &clip;
+                        if (kind == "backgroundRect" || kind == "nestedRect") clipPath = &rectClip;
+                        else if (kind == "containingRect") clipPath = &containingClip;
+                        bool nested = kind == "nested" || kind == "nestedRect";
+                        for (long long i = 0; i < iterations; i++) {
+                            renderer.beginFrame();
+                            if (kind != "none") renderer.clipPath(nested ? &containingClip : clipPath);
+                            if (nested) renderer.clipPath(clipPath);
+                            renderer.drawPath(&path, &paint);
+                        }
+                        renderer.beginFrame();
+                    });
+            }
+        }
+    }
+}
+
+static void benchGradients(BenchRunner& runner) {
+    for (const char* type : { "linear", "radial" }) {
+        for (int stops : { 2, 8, 32 }) {
+            std::unique_ptr<TvgGradientBuilder> builder;
+            if (std::string(type) == "linear") builder.reset(new TvgLinearGradientBuilder(0, 0, 100, 0));
+            else builder.reset(new TvgRadialGradientBuilder(0, 0, 100, 0));
+            for (int i = 0; i < stops; i++) {
+                builder->stops.emplace_back(0xff000000 | (unsigned int)(i * 0x050301), (float)i / (stops - 1));
+            }
+            runner.run("gradientMake", { { "type", type }, { "stops", std::to_string(stops) } },
+                [&](long long iterations) {
+                    for (long long i = 0; i < iterations; i++) {
+                        TvgPaint paint;
+                        builder->make(&paint);
+                        delete paint.gradientFill;
+                    }
+                });
+        }
+    }
+}
+
+static void benchTransformStack(BenchRunner& runner) {
+    rive::Mat2D m = makeTransform("affine", 0);
+    auto scene = tvg::Scene::gen();
+    for (int depth : { 1, 8, 64 }) {
+        RiveRenderer renderer(scene.get());
+        runner.run("saveRestore", { { "depth", std::to_string(depth) } },
+            [&](long long iterations) {
+                for (long long i = 0; i < iterations; i++) {
+                    for (int d = 0; d < depth; d++) {
+                        renderer.save();
+                        renderer.transform(m);
+                    }
+                    for (int d = 0; d < depth; d++) renderer.restore();
+                }
+            });
+    }
+}
+
+/**
+ * Compare the vector kernels with the plain ones for every pair of formats,
+ * over lengths that leave tails after the vector loops, from unaligned
+ * sources, and converting in place
+ * @return false, after reporting the first difference, if any pixel differs
+ */
+static bool checkPixelConvert() {
+    const PixelFormat formats[] = { PixelFormat::ARGB8888, PixelFormat::ABGR8888, PixelFormat::ARGB8888S, PixelFormat::ABGR8888S };
+    const char* names[] = { "ARGB8888", "ABGR8888", "ARGB8888S", "ABGR8888S" };
+    const size_t counts[] = { 1, 3, 7, 15, 17, 31, 33, 1037 };
+    const size_t maxCount = 1037;
+
+    // Every alpha from transparent to opaque. Premultiplied sources keep
+    // their channels within alpha, as ThorVG writes them.
+    std::vector<uint32_t> straight(maxCount + 1);
+    std::vector<uint32_t> premultiplied(straight.size());
+    for (size_t i = 0; i < straight.size(); i++) {
+        uint32_t hash = (uint32_t)i * 2654435761u;
+        uint32_t a = i % 7 == 0 ? 0 : i % 7 == 1 ? 255 : hash >> 24;
+        straight[i] = (a << 24) | (hash & 0xffffff);
+        uint32_t pixel = a << 24;
+        for (int shift = 0; shift < 24; shift += 8) pixel |= (((hash >> shift) & 0xff) * a + 127) / 255 << shift;
+        premultiplied[i] = pixel;
+    }
+
+    std::vector<uint32_t> expected(maxCount);
+    std::vector<uint32_t> actual(maxCount);
+    bool ok = true;
+    for (int from = 0; from < 4 && ok; from++) {
+        bool isStraight = formats[from] == PixelFormat::ARGB8888S || formats[from] == PixelFormat::ABGR8888S;
+        // Offset by one so the vector loads aren't aligned
+        const uint32_t* src = (isStraight ? straight : premultiplied).data() + 1;
+        for (int to = 0; to < 4 && ok; to++) {
+            for (size_t count : counts) {
+                pixelConvertUseSimd(false);
+                convertPixels(src, formats[from], expected.data(), formats[to], count);
+                pixelConvertUseSimd(true);
+                for (bool inPlace : { false, true }) {
+                    if (inPlace) std::copy(src, src + count, actual.begin());
+                    convertPixels(inPlace ? actual.data() : src, formats[from], actual.data(), formats[to], count);
+                    for (size_t i = 0; i < count && ok; i++) {
+                        if (actual[i] == expected[i]) continue;
+                        std::cerr << "pixelConvert/kernel:" << pixelConvertKernel() << " " << names[from] << " -> " << names[to]
+                            << (inPlace ? " in place" : "") << ", " << count << " pixels: pixel " << i << " is " << std::hex
+                            << actual[i] << ", plain code gives " << expected[i] << std::dec << std::endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+    }
+    pixelConvertUseSimd(true);
+    return ok;
+}
+
+static void benchPixelConvert(BenchRunner& runner) {
+    struct Conversion {
+        const char* name;
+        PixelFormat from;
+        PixelFormat to;
+    };
+    const Conversion conversions[] = {
+        { "swizzle", PixelFormat::ARGB8888, PixelFormat::ABGR8888 },
+        { "premultiply", PixelFormat::ARGB8888S, PixelFormat::ARGB8888 },
+        { "unpremultiply", PixelFormat::ARGB8888, PixelFormat::ABGR8888S },
+    };
+    const int width = 1920;
+    const int height = 1080;
+    // Partly transparent content, so unpremultiply can't take its shortcuts
+    std::vector<uint32_t> src((size_t)width * height);
+    for (size_t i = 0; i < src.size(); i++) src[i] = (uint32_t)(i * 2654435761u) | 0x20000000;
+    std::vector<uint32_t> dst(src.size());
+
+    for (bool simd : { false, true }) {
+        pixelConvertUseSimd(simd);
+        for (const auto& conversion : conversions) {
+            runner.run("pixelConvert", { { "format", conversion.name }, { "kernel", pixelConvertKernel() } },
+                [&](long long iterations) {
+                    for (long long i = 0; i < iterations; i++) {
+                        convertPixels(src.data(), width, conversion.from, dst.data(), width, conversion.to, width, height);
+                    }
+                });
+        }
+    }
+    pixelConvertUseSimd(true);
+}
+
+static void benchAnimationApply(BenchRunner& runner) {
+    // Each instance imports the file, so every artboard has its own objects
+    struct Instance {
+        std::unique_ptr<rive::File> file;
+        rive::Artboard* artboard = nullptr;
+        std::unique_ptr<rive::LinearAnimationInstance> animation;
+        std::unique_ptr<BakedAnimationInstance> baked;
+    };
+    const int instanceCount = 256;
+    std::vector<Instance> instances(instanceCount);
+    std::shared_ptr<BakedAnimation> baked;
+    for (auto& instance : instances) {
+        rive::File* file = nullptr;
+        auto reader = rive::BinaryReader((uint8_t*)juiceriv_data, juiceriv_data_len);
+        if (rive::File::import(reader, &file) != rive::ImportResult::success) return;
+        instance.file.reset(file);
+        instance.artboard = file->artboard();
+        if (!instance.artboard || instance.artboard->animationCount() == 0) return;
+        if (!baked) {
+            baked = std::make_shared<BakedAnimation>();
+            if (!baked->bake(instance.artboard->animation(0), instance.artboard)) return;
+        }
+        instance.artboard->advance(0.0f);
+        instance.animation.reset(new rive::LinearAnimationInstance(instance.artboard->animation(0)));
+        instance.baked.reset(new BakedAnimationInstance(baked, instance.artboard));
+    }
+
+    const float dt = 1.0f / 60.0f;
+    const std::string count = std::to_string(instanceCount);
+    runner.run("animationApply", { { "source", "keyframes" }, { "instances", count } },
+        [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                for (auto& instance : instances) {
+                    instance.animation->advance(dt);
+                    instance.animation->apply(instance.artboard);
+                }
+            }
+        });
+    runner.run("animationApply", { { "source", "baked" }, { "instances", count }, { "tracks", std::to_string(baked->trackCount()) } },
+        [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) {
+                for (auto& instance : instances) {
+                    instance.baked->advance(dt);
+                    instance.baked->apply();
+                }
+            }
+        });
+}
+
+static void benchInstanceStartup(BenchRunner& runner) {
+    // Instances push their scenes onto the canvas, which is cleared without
+    // freeing after each batch so it never grows
+    auto canvas = tvg::SwCanvas::gen();
+    std::vector<std::unique_ptr<Rive>> instances;
+    const long long batch = 64;
+    auto startup = [&](long long iterations, const std::function<std::unique_ptr<Rive>()>& create) {
+        for (long long i = 0; i < iterations; i++) {
+            instances.push_back(create());
+            if ((long long)instances.size() == batch || i == iterations - 1) {
+                instances.clear();
+                canvas->clear(false);
+            }
+        }
+    };
+
+    Rive prototype(juiceriv_data, juiceriv_data_len, canvas.get());
+    RiveSnapshot snapshot(prototype);
+    canvas->clear(false);
+
+    runner.run("instanceStartup", { { "source", "import" } },
+        [&](long long iterations) {
+            startup(iterations, [&]() { return std::unique_ptr<Rive>(new Rive(juiceriv_data, juiceriv_data_len, canvas.get())); });
+        });
+    runner.run("instanceStartup", { { "source", "snapshot" } },
+        [&](long long iterations) {
+            startup(iterations, [&]() { return snapshot.clone(canvas.get()); });
+        });
+    runner.run("snapshotCapture", {},
+        [&](long long iterations) {
+            for (long long i = 0; i < iterations; i++) RiveSnapshot capture(prototype);
+        });
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--filter" && hasValue) options.filter = argv[++i];
+        else if (arg == "--min-time" && hasValue) options.minTime = atof(argv[++i]);
+        else if (arg == "--repeats" && hasValue) options.repeats = atoi(argv[++i]);
+        else if (arg == "--json" && hasValue) options.json = argv[++i];
+        else {
+            std::cerr << "Usage: RiveRendererBench [--filter text] [--min-time 0.2] [--repeats 5] [--json results.json]" << std::endl;
+            return 1;
+        }
+    }
+    if (options.repeats < 1) options.repeats = 1;
+
+    // Everything runs on this thread
+    tvg::Initializer::init(tvg::CanvasEngine::Sw, 0);
+
+    // Timing kernels that give different results would be meaningless
+    if (!checkPixelConvert()) {
+        tvg::Initializer::term(tvg::CanvasEngine::Sw);
+        return 1;
+    }
+
+    BenchRunner runner(options);
+    benchAddRenderPath(runner);
+    benchDrawPath(runner);
+    benchGradients(runner);
+    benchTransformStack(runner);
+    benchPixelConvert(runner);
+    benchAnimationApply(runner);
+    benchInstanceStartup(runner);
+
+    int result = 0;
+    if (!options.json.empty() && !runner.writeJson(options.json)) {
+        std::cerr << "Failed to write " << options.json << std::endl;
+        result = 1;
+    }
+
+    tvg::Initializer::term(tvg::CanvasEngine::Sw);
+    return result;
+}
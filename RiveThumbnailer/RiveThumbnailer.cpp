@@ -0,0 +1,278 @@
+// RiveThumbnailer.cpp : Batch renders poster frames for every .riv file in a directory tree.
+//
+// Usage: RiveThumbnailer <input dir> <output dir> [--size 256] [--posters 4] [--threads N] [--individual]
+//
+// Every artboard of every file gets N poster frames, evenly spaced over its
+// first animation. By default the posters are laid out left to right in one
+// atlas image per artboard; --individual writes one image per poster instead.
+
+#include "thorvg.h"
+#include "../MultiRiveRenderTest/RiveRenderer.h"
+#include "../MultiRiveRenderTest/ImageWriter.h"
+#include "../common/TaskSystem.h"
+#include "artboard.hpp"
+#include "animation/linear_animation.hpp"
+#include "animation/linear_animation_instance.hpp"
+#include "core/binary_reader.hpp"
+#include "file.hpp"
+#include "layout.hpp"
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+struct ThumbnailOptions {
+    int size = 256;
+    int posters = 4;
+    int threads = 0;
+    bool individual = false;
+    fs::path input;
+    fs::path output;
+};
+
+/**
+ * @brief A double ended queue of work per thread. The owner takes work from
+ * the back, idle threads steal from the front of other threads' queues.
+ */
+class WorkStealingQueue {
+public:
+    void push(const fs::path& path) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _items.push_back(path);
+    }
+
+    bool pop(fs::path& path) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_items.empty()) return false;
+        path = std::move(_items.back());
+        _items.pop_back();
+        return true;
+    }
+
+    bool steal(fs::path& path) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_items.empty()) return false;
+        path = std::move(_items.front());
+        _items.pop_front();
+        return true;
+    }
+
+protected:
+    std::mutex _mutex;
+    std::deque<fs::path> _items;
+};
+
+/**
+ * @brief Renders thumbnails on one thread. Owns its canvas, scene and buffer
+ * so workers never share ThorVG or rive state.
+ */
+class Thumbnailer {
+public:
+    Thumbnailer(const ThumbnailOptions& options) : _options(options) {
+        _scene = tvg::Scene::gen();
+        _renderer = new RiveRenderer(_scene.get());
+        _canvas = tvg::SwCanvas::gen();
+        _canvas->push(_scene.get());
+        _buffer.resize((size_t)_options.size * _options.size * _options.posters);
+    }
+
+    ~Thumbnailer() {
+        _canvas->clear(false);
+        delete _renderer;
+    }
+
+    /**
+     * Render every artboard of a file
+     * @return The number of images written, or -1 if the file failed to load
+     * or its output directory couldn't be created
+     */
+    int render(const fs::path& path) {
+        // Runs on a worker, so filesystem errors are reported rather than thrown
+        std::error_code error;
+        fs::path relative = fs::relative(path, _options.input, error);
+        if (error) return -1;
+        fs::path base = _options.output / relative.parent_path() / relative.stem();
+        fs::create_directories(base.parent_path(), error);
+        if (error) return -1;
+
+        std::ifstream stream(path, std::ios::binary);
+        std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        if (bytes.empty()) return -1;
+
+        rive::File* file = nullptr;
+        auto reader = rive::BinaryReader(bytes.data(), bytes.size());
+        if (rive::File::import(reader, &file) != rive::ImportResult::success || !file) return -1;
+
+        int written = 0;
+        size_t count = file->artboardCount();
+        for (size_t i = 0; i < count; i++) {
+            rive::Artboard* artboard = file->artboard(i);
+            if (!artboard) continue;
+            std::string name = base.string();
+            if (count > 1) name += "_" + std::to_string(i);
+            written += renderArtboard(artboard, name);
+        }
+
+        // The scene holds shapes owned by the file's paths
+        _renderer->beginFrame();
+        delete file;
+        return written;
+    }
+
+protected:
+    int renderArtboard(rive::Artboard* artboard, const std::string& name) {
+        int size = _options.size;
+        int posters = _options.posters;
+        int stride = _options.individual ? size : size * posters;
+
+        rive::LinearAnimationInstance* animation = nullptr;
+        double duration = 0;
+        if (artboard->animationCount() > 0) {
+            animation = new rive::LinearAnimationInstance(artboard->animation(0));
+            duration = (double)animation->animation()->duration() / animation->animation()->fps();
+        }
+
+        int written = 0;
+        for (int p = 0; p < posters; p++) {
+            // Posters sit in the middle of equal slices of the animation, so
+            // a single poster shows the middle rather than the first frame
+            if (animation) {
+                animation->time((p + 0.5) * duration / posters);
+                animation->apply(artboard);
+            }
+            artboard->advance(0.0f);
+
+            _renderer->beginFrame();
+            _renderer->save();
+            _renderer->align(rive::Fit::contain,
+                rive::Alignment::center,
+                rive::AABB(0, 0, size, size),
+                artboard->bounds());
+            artboard->draw(_renderer);
+            _renderer->restore();
+
+            uint32_t* target = _options.individual ? _buffer.data() : _buffer.data() + p * size;
+            _canvas->target(target, stride, size, size, tvg::SwCanvas::ARGB8888);
+            _canvas->update(_scene.get());
+            if (_canvas->draw() == tvg::Result::Success) _canvas->sync();
+
+            if (_options.individual) {
+                if (writePng(name + "_" + std::to_string(p) + ".png", _buffer.data(), size, size, size)) written++;
+            }
+        }
+        if (!_options.individual) {
+            if (writePng(name + ".png", _buffer.data(), stride, stride, size)) written++;
+        }
+
+        delete animation;
+        return written;
+    }
+
+    ThumbnailOptions _options;
+    std::unique_ptr<tvg::Scene> _scene;
+    std::unique_ptr<tvg::SwCanvas> _canvas;
+    RiveRenderer* _renderer;
+    std::vector<uint32_t> _buffer;
+};
+
+int main(int argc, char* argv[])
+{
+    ThumbnailOptions options;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--size" && hasValue) options.size = atoi(argv[++i]);
+        else if (arg == "--posters" && hasValue) options.posters = atoi(argv[++i]);
+        else if (arg == "--threads" && hasValue) options.threads = atoi(argv[++i]);
+        else if (arg == "--individual") options.individual = true;
+        else positional.push_back(arg);
+    }
+    if (positional.size() != 2 || options.size <= 0 || options.posters <= 0) {
+        std::cerr << "Usage: RiveThumbnailer <input dir> <output dir> [--size 256] [--posters 4] [--threads N] [--individual]" << std::endl;
+        return 1;
+    }
+    options.input = positional[0];
+    options.output = positional[1];
+
+    // Each file is rendered by a single thread, so ThorVG's own pool would
+    // only compete with ours
+    TaskSystem::Options taskOptions;
+    taskOptions.threads = options.threads;
+    taskOptions.rasterThreads = 0;
+    TaskSystem tasks(taskOptions);
+    int threads = tasks.workerThreads();
+
+    // Deal the files out round robin, stealing evens out the rest
+    std::vector<WorkStealingQueue> queues(threads);
+    size_t total = 0;
+    std::error_code error;
+    fs::recursive_directory_iterator entries(options.input, fs::directory_options::skip_permission_denied, error);
+    if (error) {
+        std::cerr << "Can't read " << options.input.string() << ": " << error.message() << std::endl;
+        return 1;
+    }
+    for (; !error && entries != fs::recursive_directory_iterator(); entries.increment(error)) {
+        std::error_code typeError;
+        if (entries->is_regular_file(typeError) && entries->path().extension() == ".riv") {
+            queues[total++ % threads].push(entries->path());
+        }
+    }
+    if (error) std::cerr << "Stopped listing " << options.input.string() << ": " << error.message() << std::endl;
+
+    std::atomic<int> filesDone(0);
+    std::atomic<int> filesFailed(0);
+    std::atomic<int> imagesWritten(0);
+
+    auto worker = [&](int index) {
+        Thumbnailer thumbnailer(options);
+        fs::path path;
+        while (true) {
+            bool found = queues[index].pop(path);
+            for (int i = 1; !found && i < threads; i++) {
+                found = queues[(index + i) % threads].steal(path);
+            }
+            // Nothing is added once the workers start, so empty everywhere means done
+            if (!found) break;
+
+            int written = thumbnailer.render(path);
+            if (written < 0) {
+                filesFailed++;
+                std::cerr << "Failed to render " << path.string() << std::endl;
+            }
+            else imagesWritten += written;
+            filesDone++;
+        }
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < threads; i++) tasks.submit([&worker, i]() { worker(i); });
+
+    // Report progress while the workers run
+    std::atomic<bool> finished(false);
+    std::thread reporter([&]() {
+        while (!finished) {
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+            double seconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count() / 1000.0;
+            if (!finished) std::cout << filesDone << "/" << total << " files, " << int(filesDone / seconds) << " files/sec" << std::endl;
+        }
+    });
+
+    tasks.wait();
+    finished = true;
+    reporter.join();
+
+    double seconds = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count() / 1000000.0;
+    std::cout << "Rendered " << filesDone << " files (" << filesFailed << " failed, " << imagesWritten << " images) in "
+        << seconds << "s: " << (seconds > 0 ? filesDone / seconds : 0) << " files/sec on " << threads << " threads" << std::endl;
+    tasks.printStats(std::cout);
+    return filesFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+#include "TaskSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// The CPUs the process may run on, in order
+static std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+#ifdef _WIN32
+    DWORD_PTR processMask, systemMask;
+    if (GetProcessAffinityMask(GetCurrentProcess(), &processMask, &systemMask)) {
+        for (int i = 0; i < (int)sizeof(DWORD_PTR) * 8; i++) {
+            if (processMask & ((DWORD_PTR)1 << i)) cpus.push_back(i);
+        }
+    }
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int i = 0; i < CPU_SETSIZE; i++) {
+            if (CPU_ISSET(i, &set)) cpus.push_back(i);
+        }
+    }
+#endif
+    return cpus;
+}
+
+#ifdef __linux__
+// CPUs allowed by a cgroup quota, 0 if there is none. Quotas are time per
+// period, a quota of 1.5 periods can keep two threads mostly busy.
+static int cgroupCpus() {
+    // cgroup v2, the process's own group first, then the root a container sees
+    std::vector<std::string> candidates;
+    std::ifstream self("/proc/self/cgroup");
+    std::string line;
+    while (std::getline(self, line)) {
+        if (line.compare(0, 3, "0::") == 0) candidates.push_back("/sys/fs/cgroup" + line.substr(3) + "/cpu.max");
+    }
+    candidates.push_back("/sys/fs/cgroup/cpu.max");
+    for (const auto& path : candidates) {
+        std::ifstream file(path);
+        std::string quota;
+        double period = 0;
+        if (file >> quota >> period) {
+            if (quota == "max" || period <= 0) return 0;
+            return std::max(1, (int)std::ceil(std::stod(quota) / period));
+        }
+    }
+
+    // cgroup v1
+    for (const char* dir : { "/sys/fs/cgroup/cpu/", "/sys/fs/cgroup/cpu,cpuacct/" }) {
+        std::ifstream quotaFile(std::string(dir) + "cpu.cfs_quota_us");
+        std::ifstream periodFile(std::string(dir) + "cpu.cfs_period_us");
+        double quota = 0, period = 0;
+        if (quotaFile >> quota && periodFile >> period) {
+            if (quota <= 0 || period <= 0) return 0;
+            return std::max(1, (int)std::ceil(quota / period));
+        }
+    }
+    return 0;
+}
+#endif
+
+int TaskSystem::availableCpus() {
+    int cpus = (int)std::thread::hardware_concurrency();
+    if (cpus <= 0) cpus = 1;
+    size_t allowed = allowedCpus().size();
+    if (allowed > 0) cpus = std::min(cpus, (int)allowed);
+#ifdef __linux__
+    int quota = cgroupCpus();
+    if (quota > 0) cpus = std::min(cpus, quota);
+#endif
+    return cpus;
+}
+
+TaskSystem::TaskSystem(const Options& options) {
+    int budget = options.threads > 0 ? options.threads : availableCpus();
+    _rasterThreads = options.rasterThreads >= 0 ? std::min(options.rasterThreads, budget) : (budget + 1) / 2;
+    _pin = options.pin;
+    _statsStart = Clock::now();
+
+    tvg::Initializer::init(tvg::CanvasEngine::Sw, _rasterThreads);
+
+    int workers = budget - _rasterThreads;
+    for (int i = 0; i < workers; i++) {
+        _workers.emplace_back(&TaskSystem::workerLoop, this, i);
+        if (_pin) pinWorker(_workers.back(), i);
+    }
+}
+
+TaskSystem::~TaskSystem() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+    }
+    _workAvailable.notify_all();
+    for (auto& thread : _workers) thread.join();
+    tvg::Initializer::term(tvg::CanvasEngine::Sw);
+}
+
+void TaskSystem::pinWorker(std::thread& thread, int index) {
+    std::vector<int> cpus = allowedCpus();
+    if (cpus.empty()) return;
+    // Workers take CPUs from the end, ThorVG's threads and the main thread
+    // tend to land on the first ones
+    int cpu = cpus[cpus.size() - 1 - index % cpus.size()];
+#ifdef _WIN32
+    SetThreadAffinityMask(thread.native_handle(), (DWORD_PTR)1 << cpu);
+#elif defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+    (void)thread;
+    (void)cpu;
+#endif
+}
+
+void TaskSystem::workerLoop(int index) {
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _workAvailable.wait(lock, [this] { return _stopping || !_queue.empty(); });
+        if (_queue.empty()) return;
+
+        std::function<void()> task = std::move(_queue.front());
+        _queue.pop_front();
+        _running++;
+        lock.unlock();
+
+        auto start = Clock::now();
+        task();
+        _busyNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+        _tasks++;
+
+        lock.lock();
+        if (--_running == 0 && _queue.empty()) _idle.notify_all();
+    }
+}
+
+void TaskSystem::submit(std::function<void()> task) {
+    if (_workers.empty()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _queue.push_back(std::move(task));
+    }
+    _workAvailable.notify_one();
+}
+
+void TaskSystem::wait() {
+    std::unique_lock<std::mutex> lock(_mutex);
+    _idle.wait(lock, [this] { return _running == 0 && _queue.empty(); });
+}
+
+void TaskSystem::parallelFor(int count, const std::function<void(int)>& body) {
+    if (count <= 0) return;
+
+    // Indices are handed out one at a time, so uneven bodies balance out.
+    // The state is shared so helpers that start after the last index is
+    // done find nothing left and return.
+    struct Range {
+        std::atomic<int> next{ 0 };
+        std::atomic<int> done{ 0 };
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto range = std::make_shared<Range>();
+    auto run = [range, count, &body]() {
+        int i;
+        while ((i = range->next++) < count) {
+            body(i);
+            if (++range->done == count) {
+                std::lock_guard<std::mutex> lock(range->mutex);
+                range->finished.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min((int)_workers.size(), count - 1);
+    for (int i = 0; i < helpers; i++) submit(run);
+    run();
+
+    // body is only used while indices remain, so returning once they are
+    // all done is safe even if helpers haven't started yet
+    std::unique_lock<std::mutex> lock(range->mutex);
+    range->finished.wait(lock, [&] { return range->done == count; });
+}
+
+bool TaskSystem::raster(tvg::Canvas* canvas) {
+    auto start = Clock::now();
+    bool drawn = canvas->draw() == tvg::Result::Success;
+    if (drawn) canvas->sync();
+    _rasterNanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+    _rasters++;
+    return drawn;
+}
+
+std::vector<TaskSystem::PoolStats> TaskSystem::stats() const {
+    double wall = std::chrono::duration<double>(Clock::now() - _statsStart).count();
+    double busy = _busyNanoseconds / 1e9;
+    double rasterBusy = _rasterNanoseconds / 1e9;
+    int workers = (int)_workers.size();
+    return {
+        { "workers", workers, _tasks.load(), busy, wall > 0 && workers > 0 ? busy / (wall * workers) : 0 },
+        { "thorvg", _rasterThreads, _rasters.load(), rasterBusy, wall > 0 ? rasterBusy / wall : 0 },
+    };
+}
+
+void TaskSystem::resetStats() {
+    _statsStart = Clock::now();
+    _tasks = 0;
+    _busyNanoseconds = 0;
+    _rasters = 0;
+    _rasterNanoseconds = 0;
+}
+
+void TaskSystem::printStats(std::ostream& out) const {
+    for (const auto& pool : stats()) {
+        out << pool.name << ": " << pool.threads << " threads, " << pool.tasks << " tasks, "
+            << pool.busySeconds << "s busy, " << int(pool.utilization * 100 + 0.5) << "% utilization" << std::endl;
+    }
+}
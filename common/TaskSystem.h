@@ -0,0 +1,123 @@
+#pragma once
+
+#include "thorvg.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief One thread budget for a process, shared between ThorVG's
+ * rasterization threads and a pool of workers for application tasks.
+ *
+ * ThorVG runs its own scheduler and can't be handed tasks, so it is given
+ * its share of the budget when the task system initializes it and the rest
+ * goes to the workers. Together they never ask for more threads than the
+ * process can actually run on, which in a container with a CPU quota can be
+ * far fewer than std::thread::hardware_concurrency reports.
+ *
+ * Construct one before any canvas is created, it initializes and terminates
+ * ThorVG's software engine.
+ */
+class TaskSystem {
+public:
+    struct Options {
+        // The whole budget. 0 uses availableCpus()
+        int threads = 0;
+        // ThorVG's share of the budget, the rest are workers. -1 gives ThorVG
+        // half, rounded up
+        int rasterThreads = -1;
+        // Pin each worker to its own CPU, from the end of the CPUs the
+        // process may use. ThorVG's threads are left to the OS.
+        bool pin = false;
+    };
+
+    struct PoolStats {
+        const char* name;
+        int threads;
+        // Tasks run, or rasters for ThorVG
+        uint64_t tasks;
+        // Time spent running them, summed over threads
+        double busySeconds;
+        // Busy time over the time the pool's threads were available. For
+        // ThorVG, whose threads can't be observed, the average number of
+        // rasters in progress.
+        double utilization;
+    };
+
+    /**
+     * The number of CPUs the process can run on: the smallest of the
+     * hardware thread count, the process affinity mask and any cgroup CPU
+     * quota. Never less than 1.
+     */
+    static int availableCpus();
+
+    TaskSystem() : TaskSystem(Options()) {}
+    TaskSystem(const Options& options);
+
+    /**
+     * Waits for queued tasks, then stops the workers and ThorVG
+     */
+    ~TaskSystem();
+
+    int threads() const { return _rasterThreads + (int)_workers.size(); }
+    int rasterThreads() const { return _rasterThreads; }
+    int workerThreads() const { return (int)_workers.size(); }
+
+    /**
+     * Queue a task for the workers. With no workers it runs right away on
+     * the calling thread.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * Block until every queued task has finished
+     */
+    void wait();
+
+    /**
+     * Run body(i) for every i in [0, count) across the workers and the
+     * calling thread, returning once all are done
+     */
+    void parallelFor(int count, const std::function<void(int)>& body);
+
+    /**
+     * Draw a canvas and wait for it, counted in ThorVG's statistics
+     * @return true if the canvas was drawn
+     */
+    bool raster(tvg::Canvas* canvas);
+
+    /**
+     * Statistics since construction or the last resetStats, workers first
+     */
+    std::vector<PoolStats> stats() const;
+    void resetStats();
+    void printStats(std::ostream& out) const;
+
+protected:
+    typedef std::chrono::steady_clock Clock;
+
+    void workerLoop(int index);
+    void pinWorker(std::thread& thread, int index);
+
+    int _rasterThreads = 0;
+    bool _pin = false;
+    std::vector<std::thread> _workers;
+    std::deque<std::function<void()>> _queue;
+    std::mutex _mutex;
+    std::condition_variable _workAvailable;
+    std::condition_variable _idle;
+    int _running = 0;
+    bool _stopping = false;
+
+    Clock::time_point _statsStart;
+    std::atomic<uint64_t> _tasks{ 0 };
+    std::atomic<uint64_t> _busyNanoseconds{ 0 };
+    std::atomic<uint64_t> _rasters{ 0 };
+    std::atomic<uint64_t> _rasterNanoseconds{ 0 };
+};
@@ -0,0 +1,84 @@
+#include "HitGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+void HitGrid::clear() {
+	rects.clear();
+	cellStart.clear();
+	cellItems.clear();
+	columns = rows = 0;
+}
+
+void HitGrid::add(float minX, float minY, float maxX, float maxY) {
+	rects.push_back({ minX, minY, maxX, maxY });
+}
+
+void HitGrid::build() {
+	cellStart.clear();
+	cellItems.clear();
+	columns = rows = 0;
+	if (rects.empty()) return;
+
+	float maxX = rects[0].maxX;
+	float maxY = rects[0].maxY;
+	originX = rects[0].minX;
+	originY = rects[0].minY;
+	for (auto& r : rects) {
+		originX = std::min(originX, r.minX);
+		originY = std::min(originY, r.minY);
+		maxX = std::max(maxX, r.maxX);
+		maxY = std::max(maxY, r.maxY);
+	}
+
+	// Roughly one rectangle per cell, capped so the grid stays small
+	int cells = (int)std::ceil(std::sqrt((double)rects.size()));
+	columns = rows = std::max(1, std::min(cells, 64));
+	cellWidth = std::max((maxX - originX) / columns, 1e-3f);
+	cellHeight = std::max((maxY - originY) / rows, 1e-3f);
+
+	auto cellRange = [&](const Rect& r, int& x0, int& y0, int& x1, int& y1) {
+		x0 = std::max(0, std::min(columns - 1, (int)((r.minX - originX) / cellWidth)));
+		y0 = std::max(0, std::min(rows - 1, (int)((r.minY - originY) / cellHeight)));
+		x1 = std::max(0, std::min(columns - 1, (int)((r.maxX - originX) / cellWidth)));
+		y1 = std::max(0, std::min(rows - 1, (int)((r.maxY - originY) / cellHeight)));
+	};
+
+	// Count, prefix sum, then fill
+	cellStart.assign(columns * rows + 1, 0);
+	for (auto& r : rects) {
+		int x0, y0, x1, y1;
+		cellRange(r, x0, y0, x1, y1);
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++) cellStart[y * columns + x + 1]++;
+	}
+	for (size_t c = 1; c < cellStart.size(); c++) cellStart[c] += cellStart[c - 1];
+
+	cellItems.resize(cellStart.back());
+	std::vector<int> fill(cellStart.begin(), cellStart.end() - 1);
+	for (int i = 0; i < (int)rects.size(); i++) {
+		int x0, y0, x1, y1;
+		cellRange(rects[i], x0, y0, x1, y1);
+		for (int y = y0; y <= y1; y++)
+			for (int x = x0; x <= x1; x++) cellItems[fill[y * columns + x]++] = i;
+	}
+}
+
+bool HitGrid::hitAny(float x, float y) const {
+	if (columns == 0) return false;
+	int cx = (int)std::floor((x - originX) / cellWidth);
+	int cy = (int)std::floor((y - originY) / cellHeight);
+	if (cx < 0 || cy < 0 || cx >= columns || cy >= rows) {
+		// Points on the far edge belong to the last cell
+		if (cx == columns && x <= originX + cellWidth * columns) cx--;
+		if (cy == rows && y <= originY + cellHeight * rows) cy--;
+		if (cx < 0 || cy < 0 || cx >= columns || cy >= rows) return false;
+	}
+
+	int c = cy * columns + cx;
+	for (int i = cellStart[c]; i < cellStart[c + 1]; i++) {
+		const Rect& r = rects[cellItems[i]];
+		if (x >= r.minX && x <= r.maxX && y >= r.minY && y <= r.maxY) return true;
+	}
+	return false;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A uniform grid over axis aligned rectangles, answering "is this point
+ * inside any of them" without testing every rectangle. Used to decide
+ * whether a pointer event can reach any state machine listener before
+ * handing it to rive's precise hit testing.
+ */
+class HitGrid {
+protected:
+	struct Rect {
+		float minX, minY, maxX, maxY;
+	};
+	std::vector<Rect> rects;
+	// Cell contents, cellStart[c] to cellStart[c + 1] index into cellItems
+	std::vector<int> cellStart;
+	std::vector<int> cellItems;
+	float originX = 0;
+	float originY = 0;
+	float cellWidth = 1;
+	float cellHeight = 1;
+	int columns = 0;
+	int rows = 0;
+
+public:
+	/**
+	 * Remove all rectangles
+	 */
+	void clear();
+
+	/**
+	 * Add a rectangle. Call build once all rectangles are added.
+	 */
+	void add(float minX, float minY, float maxX, float maxY);
+
+	/**
+	 * Bin the rectangles into cells
+	 */
+	void build();
+
+	/**
+	 * @return The number of rectangles in the grid
+	 */
+	size_t size() const { return rects.size(); }
+
+	/**
+	 * @return true if the point lies inside any rectangle
+	 */
+	bool hitAny(float x, float y) const;
+};
@@ -0,0 +1,46 @@
+#include "InputQueue.h"
+
+InputQueue::InputQueue(size_t capacity) {
+	size_t size = 2;
+	while (size < capacity) size <<= 1;
+	mask = size - 1;
+	slots.reset(new Slot[size]);
+	// A slot is free for the producer at position p when its sequence is p,
+	// and ready for the consumer when it is p + 1
+	for (size_t i = 0; i < size; i++) slots[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+bool InputQueue::push(const InputChange& change) {
+	size_t position = head.load(std::memory_order_relaxed);
+	Slot* slot;
+	for (;;) {
+		slot = &slots[position & mask];
+		size_t sequence = slot->sequence.load(std::memory_order_acquire);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+		if (diff == 0) {
+			if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+		}
+		// The consumer hasn't freed this slot from the previous lap yet
+		else if (diff < 0) return false;
+		// Another producer claimed it first
+		else position = head.load(std::memory_order_relaxed);
+	}
+	slot->change = change;
+	slot->sequence.store(position + 1, std::memory_order_release);
+	return true;
+}
+
+bool InputQueue::pop(InputChange& change) {
+	Slot& slot = slots[tail & mask];
+	if (slot.sequence.load(std::memory_order_acquire) != tail + 1) return false;
+	change = slot.change;
+	// Free the slot for the producer one lap ahead
+	slot.sequence.store(tail + mask + 1, std::memory_order_release);
+	tail++;
+	return true;
+}
+
+void InputQueue::clear() {
+	InputChange change;
+	while (pop(change)) {}
+}
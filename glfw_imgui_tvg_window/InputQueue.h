@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * A change to one of a state machine instance's inputs
+ */
+struct InputChange {
+	enum Type {
+		Number,
+		Bool,
+		Trigger
+	};
+	Type type;
+	// The input's index in the state machine instance
+	uint32_t input;
+	// The new value of a number, non zero for true for a bool
+	float value;
+};
+
+/**
+ * Carries input changes from any number of producer threads to the thread
+ * that advances the state machine, without locks. A fixed ring of slots,
+ * each with a sequence number telling producers and the consumer whose turn
+ * it is; producers claim slots with a compare and swap on head, the single
+ * consumer follows behind at tail. Changes come out in the order their
+ * slots were claimed, so the changes of any one producer stay in order.
+ */
+class InputQueue {
+protected:
+	struct Slot {
+		std::atomic<size_t> sequence;
+		InputChange change;
+	};
+	std::unique_ptr<Slot[]> slots;
+	size_t mask;
+	// Producers and the consumer each get their own cache line
+	alignas(64) std::atomic<size_t> head{ 0 };
+	alignas(64) size_t tail = 0;
+
+public:
+	/**
+	 * @param capacity The number of changes that can be waiting, rounded up
+	 * to a power of two
+	 */
+	explicit InputQueue(size_t capacity = 1024);
+
+	/**
+	 * Queue a change. Safe to call from any thread.
+	 * @return false if the queue is full and the change was dropped
+	 */
+	bool push(const InputChange& change);
+
+	/**
+	 * Take the oldest change. Consumer thread only.
+	 * @return false if there is none
+	 */
+	bool pop(InputChange& change);
+
+	/**
+	 * Hand every change queued before the call to apply, oldest first.
+	 * Changes pushed while draining wait for the next call, so a frame
+	 * applies a fixed batch. Consumer thread only.
+	 * @return The number of changes applied
+	 */
+	template <typename Apply>
+	size_t drain(Apply apply) {
+		size_t end = head.load(std::memory_order_acquire);
+		size_t count = 0;
+		InputChange change;
+		// A slot that is claimed but not yet written stops the batch, the
+		// changes behind it are applied next time to keep their order
+		while (tail != end && pop(change)) {
+			apply(change);
+			count++;
+		}
+		return count;
+	}
+
+	/**
+	 * Drop every waiting change. Consumer thread only.
+	 */
+	void clear();
+};
@@ -0,0 +1,42 @@
+#include "PointerQueue.h"
+
+void PointerQueue::move(float x, float y) {
+	pending.push_back({ PointerEvent::Move, x, y, 0 });
+}
+
+void PointerQueue::button(int button, bool down, float x, float y) {
+	pending.push_back({ down ? PointerEvent::Down : PointerEvent::Up, x, y, button });
+}
+
+const std::vector<PointerEvent>& PointerQueue::drain() {
+	coalesced.clear();
+	float minDistance2 = minDistance * minDistance;
+
+	for (size_t i = 0; i < pending.size(); i++) {
+		const PointerEvent& e = pending[i];
+
+		if (e.type == PointerEvent::Move) {
+			float dx = e.x - lastX;
+			float dy = e.y - lastY;
+			if (dx == 0 && dy == 0) continue;
+
+			// Keep the last move before a button event or the end of the frame
+			bool endOfRun = i + 1 == pending.size() || pending[i + 1].type != PointerEvent::Move;
+			if (!endOfRun && dx * dx + dy * dy < minDistance2) continue;
+		}
+		else {
+			// Buttons are tracked so repeated downs or stray ups are not sent
+			unsigned mask = 1u << (e.button & 31);
+			bool isDown = (buttons & mask) != 0;
+			if ((e.type == PointerEvent::Down) == isDown) continue;
+			buttons ^= mask;
+		}
+
+		coalesced.push_back(e);
+		lastX = e.x;
+		lastY = e.y;
+	}
+
+	pending.clear();
+	return coalesced;
+}
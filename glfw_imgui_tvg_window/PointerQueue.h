@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A pointer event as received from GLFW, in framebuffer pixels
+ */
+struct PointerEvent {
+	enum Type {
+		Move,
+		Down,
+		Up
+	};
+	Type type;
+	float x;
+	float y;
+	int button;
+};
+
+/**
+ * Collects raw pointer events between frames and hands them over once per
+ * frame, coalesced. Every button transition is kept along with the position
+ * it happened at. Moves that do not change the position are dropped, and
+ * runs of moves are thinned to those that travel at least minDistance, the
+ * last move of a run is always kept so the final position is exact.
+ */
+class PointerQueue {
+protected:
+	std::vector<PointerEvent> pending;
+	std::vector<PointerEvent> coalesced;
+	float lastX = -1e9f;
+	float lastY = -1e9f;
+	unsigned buttons = 0;
+
+public:
+	float minDistance = 1.0f;
+
+	/**
+	 * Queue a cursor move
+	 */
+	void move(float x, float y);
+
+	/**
+	 * Queue a button transition at the current cursor position
+	 */
+	void button(int button, bool down, float x, float y);
+
+	/**
+	 * @return true if any button is currently held down
+	 */
+	bool anyDown() const { return buttons != 0; }
+
+	/**
+	 * Coalesce and return the events queued since the last call. The result
+	 * is valid until the next call.
+	 */
+	const std::vector<PointerEvent>& drain();
+};
@@ -1,7 +1,11 @@
 #include "TvgWindow.h"
+#include "HitGrid.h"
+#include "InputQueue.h"
 
 #include "rive/animation/linear_animation_instance.hpp"
+#include "rive/animation/state_machine.hpp"
 #include "rive/animation/state_machine_instance.hpp"
+#include "rive/animation/state_machine_listener.hpp"
 #include "rive/animation/state_machine_input_instance.hpp"
 #include "rive/animation/state_machine_number.hpp"
 #include "rive/animation/state_machine_bool.hpp"
@@ -10,15 +14,39 @@
 #include "rive/file.hpp"
 #include "rive/layout.hpp"
 #include "rive/math/aabb.hpp"
+#include "rive/math/mat2d.hpp"
+#include "rive/shapes/shape.hpp"
 #include "tvg_renderer.hpp"
 
+#include <algorithm>
 #include <stdio.h>
+#include <string.h>
 
-// ImGui wants raw pointers to names, but our public API returns
-// names as strings (by value), so we cache these names each time we
-// load a file
-std::vector<std::string> animationNames;
-std::vector<std::string> stateMachineNames;
+/**
+ * TvgRenderer that counts the draw calls of each frame for the profiler
+ */
+class CountingTvgRenderer : public rive::TvgRenderer {
+public:
+	int paths = 0;
+	int clips = 0;
+
+	CountingTvgRenderer(tvg::Canvas* canvas) : rive::TvgRenderer(canvas) {}
+
+	void drawPath(rive::RenderPath* path, rive::RenderPaint* paint) override {
+		paths++;
+		rive::TvgRenderer::drawPath(path, paint);
+	}
+
+	void clipPath(rive::RenderPath* path) override {
+		clips++;
+		rive::TvgRenderer::clipPath(path);
+	}
+
+	void resetCounts() {
+		paths = 0;
+		clips = 0;
+	}
+};
 
 class RiveExample : public TvgWindow {
 protected:
@@ -36,18 +64,93 @@ protected:
 	int animationIndex = 0;
 	int stateMachineIndex = -1;
 
-	std::unique_ptr<rive::TvgRenderer> renderer = nullptr;
+	// ImGui wants raw pointers to names, but our public API returns
+	// names as strings (by value), so we cache these names each time we
+	// load a file
+	std::vector<std::string> animationNames;
+	std::vector<std::string> stateMachineNames;
+
+	// Bounds of the shapes the state machine's listeners are attached to, in
+	// artboard space. Pointer events that can't reach any of them are not
+	// posted, so rive's exact hit testing only runs when it can matter.
+	HitGrid listenerGrid;
+	// The shapes under the listeners' targets, found once per state machine
+	std::vector<rive::Shape*> listenerShapes;
+	// Set when the artboard may have moved since the grid was built
+	bool listenerGridDirty = true;
+	bool pointerWasOverListener = false;
+
+	std::unique_ptr<CountingTvgRenderer> renderer = nullptr;
+
+	// Whether the last advance changed anything, for on demand drawing
+	bool playing = false;
+
+	// Changes to the state machine's inputs from the GUI and other threads,
+	// applied in one batch before each advance
+	InputQueue inputs;
+
+	bool queueInput(const InputChange& change) {
+		if (!inputs.push(change)) return false;
+		requestRedraw();
+		return true;
+	}
+
+	void applyInputs() {
+		inputs.drain([this](const InputChange& change) {
+			// The change may have been queued for a different state machine
+			if (change.input >= stateMachineInstance->inputCount()) return;
+			auto inputInstance = stateMachineInstance->input(change.input);
+			auto input = inputInstance->input();
+			if (change.type == InputChange::Number && input->is<rive::StateMachineNumber>()) {
+				static_cast<rive::SMINumber*>(inputInstance)->value(change.value);
+			}
+			else if (change.type == InputChange::Bool && input->is<rive::StateMachineBool>()) {
+				static_cast<rive::SMIBool*>(inputInstance)->value(change.value != 0);
+			}
+			else if (change.type == InputChange::Trigger && input->is<rive::StateMachineTrigger>()) {
+				static_cast<rive::SMITrigger*>(inputInstance)->fire();
+			}
+		});
+	}
 public:
 	/**
 	 * Pass-through constructor
 	 */
-	RiveExample() : TvgWindow() {}
+	RiveExample(std::string name = "New Window", bool decoupled = false, bool drawOnDemand = false, bool scaleResolution = false) : TvgWindow(800, 600, name) {
+		decoupledRaster = decoupled;
+		onDemand = drawOnDemand;
+		dynamicResolution = scaleResolution;
+	}
+
+	/**
+	 * Set a number input of the current state machine. Safe to call from any
+	 * thread, changes are applied in order before the next advance.
+	 * @param input The input's index in the state machine
+	 * @return false if the queue is full
+	 */
+	bool setNumber(uint32_t input, float value) {
+		return queueInput({ InputChange::Number, input, value });
+	}
+
+	/**
+	 * Set a bool input of the current state machine, see setNumber
+	 */
+	bool setBool(uint32_t input, bool value) {
+		return queueInput({ InputChange::Bool, input, value ? 1.0f : 0.0f });
+	}
+
+	/**
+	 * Fire a trigger input of the current state machine, see setNumber
+	 */
+	bool fireTrigger(uint32_t input) {
+		return queueInput({ InputChange::Trigger, input, 0.0f });
+	}
 
 	/**
 	 * Set up renderer. Start listening for dropped files.
 	 */
 	void setup() override {
-		renderer = std::unique_ptr<rive::TvgRenderer>(new rive::TvgRenderer(canvas.get()));
+		renderer = std::unique_ptr<CountingTvgRenderer>(new CountingTvgRenderer(canvas.get()));
 		clearColor = 0xffff9900;
 	}
 	/**
@@ -55,28 +158,43 @@ public:
 	 **/
 	void update(double dt) override {
 		if (artboardInstance != nullptr) {
+			bool wasPlaying = playing;
+			playing = false;
 			if (animationInstance != nullptr) {
-				animationInstance->advance(dt);
+				playing = animationInstance->advance(dt);
 				animationInstance->apply();
 			}
 			else if (stateMachineInstance != nullptr) {
-				stateMachineInstance->advance(dt);
+				applyInputs();
+				playing = stateMachineInstance->advance(dt);
+				// The advance that settles still applies the final pose, only
+				// the ones after it leave every shape where it was
+				if (playing || wasPlaying) listenerGridDirty = true;
 			}
 			artboardInstance->advance(dt);
 
 			// Render the rive animation
 			canvas->clear();
+			renderer->resetCounts();
 			renderer->save();
 			renderer->align(rive::Fit::contain,
 				rive::Alignment::center,
-				rive::AABB(0, 0, width, height),
+				rive::AABB(0, 0, renderWidth, renderHeight),
 				artboardInstance->bounds());
-			applyMouseEvent(artboardInstance.get());
+			applyPointerEvents(artboardInstance.get());
 			artboardInstance->draw(renderer.get());
 			renderer->restore();
-			if (canvas->draw() == tvg::Result::Success) canvas->sync();
+			drawCanvas();
+
+			profiler.counter("Shapes", renderer->paths);
+			profiler.counter("Clips", renderer->clips);
+			profiler.counter("Resolution %", (int)(renderScale * 100 + 0.5f));
 		}
 	}
+	bool animating() override {
+		return playing;
+	}
+
 	void updateGui(double dt) override {
 		if (artboardInstance != nullptr) {
 			
@@ -87,10 +205,10 @@ public:
 					"##Animations",
 					&animationIndex,
 					[](void* data, int index, const char** name) {
-						*name = animationNames[index].c_str();
+						*name = (*static_cast<std::vector<std::string>*>(data))[index].c_str();
 						return true;
 					},
-					artboardInstance.get(),
+					&animationNames,
 						animationNames.size(),
 						4))
 				{
@@ -104,10 +222,10 @@ public:
 					"##State Machines",
 					&stateMachineIndex,
 					[](void* data, int index, const char** name) {
-						*name = stateMachineNames[index].c_str();
+						*name = (*static_cast<std::vector<std::string>*>(data))[index].c_str();
 						return true;
 					},
-					artboardInstance.get(),
+					&stateMachineNames,
 						stateMachineNames.size(),
 						4))
 				{
@@ -131,8 +249,7 @@ public:
 
 						auto number = static_cast<rive::SMINumber*>(inputInstance);
 						float v = number->value();
-						ImGui::InputFloat(label, &v, 1.0f, 2.0f, "%.3f");
-						number->value(v);
+						if (ImGui::InputFloat(label, &v, 1.0f, 2.0f, "%.3f")) setNumber(i, v);
 						ImGui::NextColumn();
 					}
 					else if (inputInstance->input()->is<rive::StateMachineTrigger>()) {
@@ -140,10 +257,7 @@ public:
 						// label but still give it an id.
 						char label[256];
 						snprintf(label, 256, "Fire##%u", i);
-						if (ImGui::Button(label)) {
-							auto trigger = static_cast<rive::SMITrigger*>(inputInstance);
-							trigger->fire();
-						}
+						if (ImGui::Button(label)) fireTrigger(i);
 						ImGui::NextColumn();
 					}
 					else if (inputInstance->input()->is<rive::StateMachineBool>()) {
@@ -154,8 +268,7 @@ public:
 						auto boolInput = static_cast<rive::SMIBool*>(inputInstance);
 						bool value = boolInput->value();
 
-						ImGui::Checkbox(label, &value);
-						boolInput->value(value);
+						if (ImGui::Checkbox(label, &value)) setBool(i, value);
 						ImGui::NextColumn();
 					}
 					ImGui::Text("%s", inputInstance->input()->name().c_str());
@@ -165,6 +278,7 @@ public:
 				ImGui::Columns(1);
 			}
 			ImGui::Text("FPS %d", int(fps));
+			ImGui::Checkbox("Profiler (F1)", &showProfiler);
 			ImGui::End();
 		}
 		else {
@@ -208,6 +322,8 @@ public:
 	}
 
 	void initStateMachine(int index) {
+		// The canvas may still be drawing shapes of the current file
+		waitRaster();
 		stateMachineIndex = index;
 		animationIndex = -1;
 		assert(fileBytes.size() != 0);
@@ -230,9 +346,15 @@ public:
 		if (index >= 0 && index < artboardInstance->stateMachineCount()) {
 			stateMachineInstance = artboardInstance->stateMachineAt(index);
 		}
+		// Changes queued for the previous state machine
+		inputs.clear();
+		pointerWasOverListener = false;
+		collectListenerShapes();
 	}
 
 	void initAnimation(int index) {
+		// The canvas may still be drawing shapes of the current file
+		waitRaster();
 		animationIndex = index;
 		stateMachineIndex = -1;
 		assert(fileBytes.size() != 0);
@@ -255,45 +377,122 @@ public:
 		if (index >= 0 && index < artboardInstance->animationCount()) {
 			animationInstance = artboardInstance->animationAt(index);
 		}
+		// Drop the previous artboard's listener shapes
+		collectListenerShapes();
 	}
 
-	void applyMouseEvent(rive::Artboard* artboard) {
-		static ImVec2 gPrevMousePos = { -1000, -1000 };
-		const auto mouse = ImGui::GetMousePos();
-
-		static bool gPrevMouseButtonDown = false;
-		const bool isDown = ImGui::IsMouseDown(ImGuiMouseButton_Left);
+	/**
+	 * Find the shapes rive hit tests for the state machine's listeners: the
+	 * target itself, or every shape under a group or the artboard
+	 */
+	void collectListenerShapes() {
+		listenerShapes.clear();
+		listenerGrid.clear();
+		listenerGridDirty = true;
+		if (stateMachineInstance == nullptr) return;
 
-		if (mouse.x == gPrevMousePos.x &&
-			mouse.y == gPrevMousePos.y &&
-			isDown == gPrevMouseButtonDown)
-		{
-			return;
+		auto artboard = artboardInstance.get();
+		auto machine = stateMachineInstance->stateMachine();
+		for (size_t i = 0; i < machine->listenerCount(); i++) {
+			auto target = artboard->resolve(machine->listener(i)->targetId());
+			if (target == nullptr) continue;
+			for (auto object : artboard->objects()) {
+				if (object == nullptr || !object->is<rive::Shape>()) continue;
+				for (rive::Component* c = object->as<rive::Component>(); c != nullptr; c = c->parent()) {
+					if (static_cast<rive::Core*>(c) == target) {
+						listenerShapes.push_back(object->as<rive::Shape>());
+						break;
+					}
+				}
+			}
 		}
+		std::sort(listenerShapes.begin(), listenerShapes.end());
+		listenerShapes.erase(std::unique(listenerShapes.begin(), listenerShapes.end()), listenerShapes.end());
+	}
 
-		auto evtType = rive::PointerEventType::move;
-		if (isDown && !gPrevMouseButtonDown) {
-			evtType = rive::PointerEventType::down; // we just went down
-		}
-		else if (!isDown && gPrevMouseButtonDown) {
-			evtType = rive::PointerEventType::up; // we just went up
+	/**
+	 * Rebuild the listener index from the current shape positions
+	 */
+	void buildListenerGrid() {
+		listenerGrid.clear();
+		for (auto shape : listenerShapes) {
+			auto bounds = shape->computeWorldBounds();
+			listenerGrid.add(bounds.minX, bounds.minY, bounds.maxX, bounds.maxY);
 		}
+		listenerGrid.build();
+		listenerGridDirty = false;
+	}
+
+	/**
+	 * Post this frame's coalesced pointer events to the artboard, mapped
+	 * from window pixels into artboard space
+	 */
+	void applyPointerEvents(rive::Artboard* artboard) {
+		const auto& events = pointers.drain();
+		if (events.empty()) return;
+
+		auto inverse = rive::computeAlignment(rive::Fit::contain,
+			rive::Alignment::center,
+			rive::AABB(0, 0, renderWidth, renderHeight),
+			artboard->bounds()).invertOrIdentity();
 
-		gPrevMousePos = mouse;
-		gPrevMouseButtonDown = isDown;
+		bool filter = stateMachineInstance != nullptr;
+		if (filter && listenerGridDirty) buildListenerGrid();
 
-		const int pointerIndex = 0; // til we track more than one button/mouse
-		rive::PointerEvent evt = {
-			evtType,
-			{mouse.x, mouse.y},
-			pointerIndex,
-		};
-		artboard->postPointerEvent(evt);
+		for (const auto& e : events) {
+			auto position = inverse * rive::Vec2D(e.x, e.y);
+
+			if (filter) {
+				// A move that starts and ends away from every listener can't
+				// enter, exit or hover anything
+				bool over = listenerGrid.hitAny(position.x, position.y);
+				bool skip = !over && (e.type != PointerEvent::Move || !pointerWasOverListener);
+				// Only what rive sees counts: a skipped press off every
+				// listener must not swallow the exit of the next move
+				if (skip) continue;
+				pointerWasOverListener = over;
+			}
+
+			auto evtType = rive::PointerEventType::move;
+			if (e.type == PointerEvent::Down) evtType = rive::PointerEventType::down;
+			else if (e.type == PointerEvent::Up) evtType = rive::PointerEventType::up;
+
+			// Each button is reported as its own pointer
+			rive::PointerEvent evt = {
+				evtType,
+				position,
+				e.button,
+			};
+			artboard->postPointerEvent(evt);
+		}
 	}
 };
 
-int main(void)
+/**
+ * Usage: RiveTizen_rive_viewer [window count] [--decoupled] [--on-demand] [--dynamic-resolution]
+ * Each window is an independent viewer with its own render thread.
+ * --decoupled rasterizes into a second buffer while the last frame is
+ * presented, so the GUI keeps its frame rate when rasterization doesn't.
+ * --on-demand only draws while something animates or after input.
+ * --dynamic-resolution lowers the render resolution to hold 60fps.
+ */
+int main(int argc, char* argv[])
 {
-	RiveExample example;
-	example.run();
+	int count = 1;
+	bool decoupled = false;
+	bool onDemand = false;
+	bool dynamicResolution = false;
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "--decoupled") == 0) decoupled = true;
+		else if (strcmp(argv[i], "--on-demand") == 0) onDemand = true;
+		else if (strcmp(argv[i], "--dynamic-resolution") == 0) dynamicResolution = true;
+		else count = std::max(1, atoi(argv[i]));
+	}
+	std::vector<std::unique_ptr<RiveExample>> examples;
+	std::vector<TvgWindow*> windows;
+	for (int i = 0; i < count; i++) {
+		examples.emplace_back(new RiveExample(count > 1 ? "Viewer " + std::to_string(i + 1) : "New Window", decoupled, onDemand, dynamicResolution));
+		windows.push_back(examples.back().get());
+	}
+	return TvgWindow::runAll(windows) ? 0 : 1;
 }
@@ -0,0 +1,108 @@
+#include "TvgFramebuffer.h"
+
+#include <algorithm>
+
+TvgFramebuffer::~TvgFramebuffer() {
+	delete[] frontPixels;
+	delete[] backPixels;
+}
+
+bool TvgFramebuffer::fits(int w, int h) const {
+	if (!frontPixels || w > stride || h > rows) return false;
+	return (float)w * h >= (float)stride * rows * minimumUse;
+}
+
+bool TvgFramebuffer::resize(int w, int h) {
+	w = std::max(1, w);
+	h = std::max(1, h);
+	if (fits(w, h)) {
+		width = w;
+		height = h;
+		return false;
+	}
+
+	if (frontPixels && w <= stride && h <= rows) {
+		// Mostly unused, give the memory back
+		stride = w;
+		rows = h;
+	}
+	else {
+		// Only grow the dimension that is too small, a window dragged wider
+		// keeps its rows
+		stride = w > stride ? std::max(w, (int)(stride * growth)) : std::max(w, stride);
+		rows = h > rows ? std::max(h, (int)(rows * growth)) : std::max(h, rows);
+	}
+	width = w;
+	height = h;
+
+	size_t size = (size_t)stride * rows;
+	delete[] frontPixels;
+	frontPixels = new uint32_t[size];
+	std::fill(frontPixels, frontPixels + size, 0);
+	delete[] backPixels;
+	backPixels = nullptr;
+	return true;
+}
+
+uint32_t* TvgFramebuffer::back() {
+	if (!backPixels && frontPixels) {
+		size_t size = (size_t)stride * rows;
+		backPixels = new uint32_t[size];
+		std::fill(backPixels, backPixels + size, 0);
+	}
+	return backPixels;
+}
+
+void TvgFramebuffer::swap() {
+	std::swap(frontPixels, backPixels);
+}
+
+void TvgFramebuffer::upload() {
+	if (!frontPixels) return;
+	if (texture == 0) {
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+	else glBindTexture(GL_TEXTURE_2D, texture);
+
+	// The texture follows the storage, so it is only respecified when the
+	// storage is reallocated
+	if (textureWidth != stride || textureHeight != rows) {
+		textureWidth = stride;
+		textureHeight = rows;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, textureWidth, textureHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	}
+
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, stride);
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, frontPixels);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TvgFramebuffer::draw(float w, float h) {
+	if (texture == 0) return;
+	// Only the part of the texture in use is stretched over the quad. Where
+	// unused texels follow, stop half a texel short so filtering can't blend
+	// them in.
+	float u = (width < textureWidth ? width - 0.5f : (float)width) / textureWidth;
+	float v = (height < textureHeight ? height - 0.5f : (float)height) / textureHeight;
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glBegin(GL_QUADS);
+	glTexCoord2f(0, 0); glVertex2f(0, 0);
+	glTexCoord2f(u, 0); glVertex2f(w, 0);
+	glTexCoord2f(u, v); glVertex2f(w, h);
+	glTexCoord2f(0, v); glVertex2f(0, h);
+	glEnd();
+	glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void TvgFramebuffer::releaseTexture() {
+	if (texture != 0) glDeleteTextures(1, &texture);
+	texture = 0;
+	textureWidth = 0;
+	textureHeight = 0;
+}
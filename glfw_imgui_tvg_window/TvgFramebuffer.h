@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include <GL/glew.h>
+
+/**
+ * The pixels a canvas draws into and the texture they are shown with.
+ * Storage is allocated with room to spare, rows of stride pixels, and a
+ * smaller size is drawn into the top left of it, so a window that is being
+ * resized only reallocates when it outgrows what is there. The texture is
+ * sized the same way and only the part in use is uploaded.
+ */
+class TvgFramebuffer {
+protected:
+	uint32_t* frontPixels = nullptr;
+	uint32_t* backPixels = nullptr;
+	GLuint texture = 0;
+	int textureWidth = 0;
+	int textureHeight = 0;
+
+	// Growth factor when the storage is outgrown, and the fraction of it
+	// that must stay in use before it is given back
+	static constexpr float growth = 1.5f;
+	static constexpr float minimumUse = 0.25f;
+
+public:
+	// The size in use, in pixels
+	int width = 0;
+	int height = 0;
+	// The allocated size, stride pixels by rows
+	int stride = 0;
+	int rows = 0;
+
+	~TvgFramebuffer();
+
+	/**
+	 * @return true if a size can be used without reallocating
+	 */
+	bool fits(int w, int h) const;
+
+	/**
+	 * Change the size in use. Storage grows geometrically when it is too
+	 * small and is reallocated to fit when mostly unused. Reallocated
+	 * storage is cleared.
+	 * @return true if the storage was reallocated
+	 */
+	bool resize(int w, int h);
+
+	/**
+	 * The buffer that is shown
+	 */
+	uint32_t* front() const { return frontPixels; }
+
+	/**
+	 * A second buffer of the same size to draw into while the front one is
+	 * shown, allocated on first use
+	 */
+	uint32_t* back();
+
+	/**
+	 * Exchange the front and back buffers
+	 */
+	void swap();
+
+	/**
+	 * Copy the part of the front buffer in use into the texture. The GL
+	 * context must be current.
+	 */
+	void upload();
+
+	/**
+	 * Draw the texture as a quad from the origin to w, h
+	 */
+	void draw(float w, float h);
+
+	/**
+	 * Delete the texture. The GL context must be current.
+	 */
+	void releaseTexture();
+};
@@ -0,0 +1,162 @@
+#include "TvgProfiler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "imgui.h"
+
+// Count heap allocations so the overlay can show allocations per frame. This
+// replaces the global allocator of the whole program, so it is opt in: build
+// with TVG_PROFILER_ALLOCATION_HOOK defined to enable it.
+#ifdef TVG_PROFILER_ALLOCATION_HOOK
+static std::atomic<uint64_t> gAllocations(0);
+
+void* operator new(std::size_t size) {
+	gAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (void* p = std::malloc(size ? size : 1)) return p;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+	std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+uint64_t TvgProfiler::allocationCount() {
+	return gAllocations.load(std::memory_order_relaxed);
+}
+#else
+uint64_t TvgProfiler::allocationCount() {
+	return 0;
+}
+#endif
+
+static const char* phaseNames[TvgProfiler::PhaseCount] = {
+	"Update",
+	"Canvas draw/sync",
+	"Texture upload",
+	"Update GUI",
+	"ImGui render",
+	"Swap"
+};
+
+TvgProfiler::TvgProfiler(int history) : history(history) {
+	frameTimes.resize(history, 0);
+	allocations.resize(history, 0);
+	for (int i = 0; i < PhaseCount; i++) phaseTimes[i].resize(history, 0);
+}
+
+void TvgProfiler::beginFrame() {
+	auto now = Clock::now();
+	uint64_t allocationsNow = allocationCount();
+
+	if (frameOpen) {
+		frameTimes[cursor] = std::chrono::duration<float, std::milli>(now - frameStart).count();
+		allocations[cursor] = (float)(allocationsNow - allocationsAtFrameStart);
+		for (int i = 0; i < PhaseCount; i++) {
+			phaseTimes[i][cursor] = current[i];
+			current[i] = 0;
+		}
+		cursor = (cursor + 1) % history;
+		frameCount++;
+	}
+
+	frameOpen = true;
+	frameStart = now;
+	allocationsAtFrameStart = allocationsNow;
+}
+
+void TvgProfiler::begin(Phase phase) {
+	phaseStart[phase] = Clock::now();
+}
+
+void TvgProfiler::end(Phase phase) {
+	current[phase] += std::chrono::duration<float, std::milli>(Clock::now() - phaseStart[phase]).count();
+}
+
+void TvgProfiler::add(Phase phase, float ms) {
+	current[phase] += ms;
+}
+
+void TvgProfiler::counter(const char* name, int value) {
+	for (auto& c : counters) {
+		if (c.first == name) {
+			c.second = value;
+			return;
+		}
+	}
+	counters.emplace_back(name, value);
+}
+
+float TvgProfiler::lastFrameTime() const {
+	if (frameCount == 0) return 0;
+	return frameTimes[(cursor + history - 1) % history];
+}
+
+float TvgProfiler::lastPhaseTime(Phase phase) const {
+	if (frameCount == 0) return 0;
+	return phaseTimes[phase][(cursor + history - 1) % history];
+}
+
+void TvgProfiler::draw(bool* open) {
+	if (!ImGui::Begin("Profiler", open)) {
+		ImGui::End();
+		return;
+	}
+
+	int count = std::min(frameCount, history);
+	if (count == 0) {
+		ImGui::Text("Collecting...");
+		ImGui::End();
+		return;
+	}
+
+	// The ring buffer is only partly filled until history frames have passed
+	int first = frameCount < history ? 0 : cursor;
+	sorted.clear();
+	for (int i = 0; i < count; i++) sorted.push_back(frameTimes[(first + i) % history]);
+	std::sort(sorted.begin(), sorted.end());
+	float sum = 0;
+	for (float t : sorted) sum += t;
+	float avg = sum / count;
+	float p99 = sorted[std::min(count - 1, (int)(count * 0.99f))];
+
+	char overlay[64];
+	snprintf(overlay, sizeof(overlay), "%.2f ms (%.0f fps)", lastFrameTime(), avg > 0 ? 1000.0f / avg : 0.0f);
+	ImGui::PlotLines("##frametimes", frameTimes.data(), count, first, overlay, 0.0f, std::max(33.3f, sorted[count - 1]), ImVec2(0, 80));
+	ImGui::Text("min %.2f  avg %.2f  p99 %.2f  max %.2f ms", sorted[0], avg, p99, sorted[count - 1]);
+
+	ImGui::Separator();
+	ImGui::Columns(3);
+	ImGui::Text("Phase"); ImGui::NextColumn();
+	ImGui::Text("Last ms"); ImGui::NextColumn();
+	ImGui::Text("Avg ms"); ImGui::NextColumn();
+	for (int p = 0; p < PhaseCount; p++) {
+		float phaseSum = 0;
+		for (int i = 0; i < count; i++) phaseSum += phaseTimes[p][(first + i) % history];
+		ImGui::Text("%s", phaseNames[p]); ImGui::NextColumn();
+		ImGui::Text("%.2f", lastPhaseTime((Phase)p)); ImGui::NextColumn();
+		ImGui::Text("%.2f", phaseSum / count); ImGui::NextColumn();
+	}
+	ImGui::Columns(1);
+
+	ImGui::Separator();
+#ifdef TVG_PROFILER_ALLOCATION_HOOK
+	float allocationSum = 0;
+	for (int i = 0; i < count; i++) allocationSum += allocations[(first + i) % history];
+	ImGui::Text("Allocations/frame: %d (avg %.1f)", (int)allocations[(cursor + history - 1) % history], allocationSum / count);
+#else
+	ImGui::TextDisabled("Allocations/frame: build with TVG_PROFILER_ALLOCATION_HOOK");
+#endif
+	for (auto& c : counters) {
+		ImGui::Text("%s: %d", c.first.c_str(), c.second);
+	}
+
+	ImGui::End();
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Collects per-frame timings for TvgWindow and draws them as an ImGui overlay.
+ * Keeps a rolling history of frame times and phase timings, plus named
+ * counters reported by the application each frame.
+ */
+class TvgProfiler {
+public:
+	enum Phase {
+		Update = 0,  // User update, building the scene
+		Raster,      // ThorVG canvas draw and sync, on the render thread
+		Upload,      // Texture upload and quad
+		Gui,         // User updateGui
+		ImGuiRender, // ImGui render
+		Swap,        // Buffer swap
+		PhaseCount
+	};
+
+	/**
+	 * @param history The number of frames to keep for the graph and statistics
+	 */
+	TvgProfiler(int history = 240);
+
+	/**
+	 * Start a new frame. Closes the previous one and records its total time.
+	 */
+	void beginFrame();
+
+	/**
+	 * Time a phase. Calls for the same phase within one frame accumulate.
+	 */
+	void begin(Phase phase);
+	void end(Phase phase);
+
+	/**
+	 * Add time measured elsewhere, e.g. on another thread, to a phase
+	 * @param ms The time in milliseconds
+	 */
+	void add(Phase phase, float ms);
+
+	/**
+	 * Report a named value for the current frame, e.g. a shape count
+	 */
+	void counter(const char* name, int value);
+
+	/**
+	 * Draw the profiler window
+	 * @param open Optional close button state, as for ImGui::Begin
+	 */
+	void draw(bool* open = nullptr);
+
+	/**
+	 * @return The number of heap allocations made since the process started,
+	 * always 0 unless built with TVG_PROFILER_ALLOCATION_HOOK
+	 */
+	static uint64_t allocationCount();
+
+	/**
+	 * @return The total time of the last complete frame in milliseconds
+	 */
+	float lastFrameTime() const;
+
+	/**
+	 * @return The time of a phase in the last complete frame in milliseconds
+	 */
+	float lastPhaseTime(Phase phase) const;
+
+protected:
+	typedef std::chrono::steady_clock Clock;
+
+	int history;
+	int frameCount = 0;
+	int cursor = 0;
+	bool frameOpen = false;
+	Clock::time_point frameStart;
+	Clock::time_point phaseStart[PhaseCount];
+	float current[PhaseCount] = {};
+	uint64_t allocationsAtFrameStart = 0;
+
+	// Ring buffers, one entry per frame
+	std::vector<float> frameTimes;
+	std::vector<float> phaseTimes[PhaseCount];
+	std::vector<float> allocations;
+
+	std::vector<std::pair<std::string, int>> counters;
+	std::vector<float> sorted;
+};
@@ -1,19 +1,108 @@
 #include "TvgWindow.h"
 
-TvgWindow* TvgWindow::instance = nullptr;
+#include <algorithm>
+#include <cmath>
+
+// GLFW and ThorVG are set up by the first window and torn down with the
+// last. Windows are only created and destroyed on the main thread.
+static int windowCount = 0;
+static std::unique_ptr<TaskSystem> taskSystem;
+TaskSystem::Options TvgWindow::taskOptions;
+
+static bool acquireLibraries() {
+	if (windowCount == 0) {
+		if (!glfwInit()) return false;
+		// Windows have no work of their own for workers, ThorVG gets all of
+		// the budget unless told otherwise
+		TaskSystem::Options options = TvgWindow::taskOptions;
+		if (options.rasterThreads < 0) options.rasterThreads = options.threads > 0 ? options.threads : TaskSystem::availableCpus();
+		taskSystem.reset(new TaskSystem(options));
+	}
+	windowCount++;
+	return true;
+}
+
+static void releaseLibraries() {
+	if (--windowCount == 0) {
+		taskSystem = nullptr;
+		glfwTerminate();
+	}
+}
+
+TaskSystem& TvgWindow::tasks() {
+	return *taskSystem;
+}
+
+static TvgWindow* windowFor(GLFWwindow* window) {
+	return static_cast<TvgWindow*>(glfwGetWindowUserPointer(window));
+}
+
+/**
+ * ImGui's GLFW callbacks act on the current ImGui context, so they are
+ * forwarded with the context of the window the event belongs to
+ */
+static TvgWindow* forwardToImGui(GLFWwindow* window) {
+	TvgWindow* target = windowFor(window);
+	// Any input may change the GUI or the scene
+	if (target) target->requestRedraw();
+	if (target && target->imguiContext()) ImGui::SetCurrentContext(target->imguiContext());
+	return target && target->imguiContext() ? target : nullptr;
+}
 
 void glfwOnFramebufferResize(GLFWwindow* window, int w, int h) {
-	TvgWindow::instance->onResize(w, h);
+	if (TvgWindow* target = windowFor(window)) target->onResize(w, h);
+}
+
+void glfwOnContentScale(GLFWwindow* window, float x, float y) {
+	if (TvgWindow* target = windowFor(window)) target->onContentScale(x);
+}
+
+void glfwOnRefresh(GLFWwindow* window) {
+	if (TvgWindow* target = windowFor(window)) target->requestRedraw();
 }
 
 void glfwOnFilesDropped(GLFWwindow* window, int count, const char** paths) {
 	std::vector<std::string> filenames;
 	for (int i = 0; i < count; i++) filenames.push_back(std::string(paths[i]));
-	TvgWindow::instance->onFilesDropped(filenames);
+	if (TvgWindow* target = windowFor(window)) {
+		target->waitRaster();
+		target->onFilesDropped(filenames);
+		target->requestRedraw();
+	}
+}
+
+void glfwOnCursorPos(GLFWwindow* window, double x, double y) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_CursorPosCallback(window, x, y);
+	if (TvgWindow* target = windowFor(window)) target->onCursorPos(x, y);
+}
+
+void glfwOnMouseButton(GLFWwindow* window, int button, int action, int mods) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_MouseButtonCallback(window, button, action, mods);
+	if (TvgWindow* target = windowFor(window)) target->onMouseButton(button, action);
+}
+
+void glfwOnScroll(GLFWwindow* window, double x, double y) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_ScrollCallback(window, x, y);
+}
+
+void glfwOnKey(GLFWwindow* window, int key, int scancode, int action, int mods) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_KeyCallback(window, key, scancode, action, mods);
+}
+
+void glfwOnChar(GLFWwindow* window, unsigned int c) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_CharCallback(window, c);
+}
+
+void glfwOnFocus(GLFWwindow* window, int focused) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_WindowFocusCallback(window, focused);
+}
+
+void glfwOnCursorEnter(GLFWwindow* window, int entered) {
+	if (forwardToImGui(window)) ImGui_ImplGlfw_CursorEnterCallback(window, entered);
 }
 
 TvgWindow::TvgWindow(int w, int h, std::string name) {
-	if (!glfwInit()) return;
+	if (!acquireLibraries()) return;
 
 	GLFWmonitor* monitor = glfwGetPrimaryMonitor();
 	const GLFWvidmode* mode = glfwGetVideoMode(monitor);
@@ -23,6 +112,9 @@ TvgWindow::TvgWindow(int w, int h, std::string name) {
 	glfwWindowHint(GLFW_REFRESH_RATE, mode->refreshRate);
 	glfwWindowHint(GLFW_STENCIL_BITS, 0);
 	glfwWindowHint(GLFW_DEPTH_BITS, 0);
+	// Sizes are in screen coordinates, scaled up on HiDPI monitors where the
+	// system doesn't do it itself
+	glfwWindowHint(GLFW_SCALE_TO_MONITOR, GLFW_TRUE);
 
 	// Decide GL+GLSL versions
 #if defined(IMGUI_IMPL_OPENGL_ES2)
@@ -49,143 +141,371 @@ TvgWindow::TvgWindow(int w, int h, std::string name) {
 
 	window = glfwCreateWindow(w, h, name.c_str(), NULL, NULL);
 	if (!window) {
-		glfwTerminate();
+		releaseLibraries();
 		return;
 	}
 
+	// Callbacks find their window through the user pointer
+	glfwSetWindowUserPointer(window, this);
 	glfwSetFramebufferSizeCallback(window, glfwOnFramebufferResize);
+	glfwSetWindowContentScaleCallback(window, glfwOnContentScale);
+	glfwSetWindowRefreshCallback(window, glfwOnRefresh);
 	glfwSetDropCallback(window, glfwOnFilesDropped);
+	glfwSetCursorPosCallback(window, glfwOnCursorPos);
+	glfwSetMouseButtonCallback(window, glfwOnMouseButton);
+	glfwSetScrollCallback(window, glfwOnScroll);
+	glfwSetKeyCallback(window, glfwOnKey);
+	glfwSetCharCallback(window, glfwOnChar);
+	glfwSetWindowFocusCallback(window, glfwOnFocus);
+	glfwSetCursorEnterCallback(window, glfwOnCursorEnter);
 
 	glfwMakeContextCurrent(window);
 	glfwSwapInterval(1);
 	glEnable(GL_TEXTURE_2D);
 
-	tvg::Initializer::init(tvg::CanvasEngine::Sw, std::thread::hardware_concurrency());
 	canvas = tvg::SwCanvas::gen();
 
-	glfwGetWindowSize(window, &width, &height);
+	glfwGetWindowContentScale(window, &contentScale, nullptr);
+	glfwGetFramebufferSize(window, &width, &height);
 	onResize(width, height);
 
 	lastTime = glfwGetTime();
-
-	TvgWindow::instance = this;
+	lastUpdateTime = lastTime;
 }
 
 TvgWindow::~TvgWindow() {
+	if (!window) return;
+	stopRenderThread();
 	glfwDestroyWindow(window);
-	glfwTerminate();
-
-	tvg::Initializer::term(tvg::CanvasEngine::Sw);
-
-	delete[] buffer;
+	canvas = nullptr;
+	releaseLibraries();
 }
 
 void TvgWindow::close() {
 	shouldClose = true;
 }
 
+void TvgWindow::onCursorPos(double x, double y) {
+	pointers.move((float)(x * renderWidth / windowWidth), (float)(y * renderHeight / windowHeight));
+}
+
+void TvgWindow::onMouseButton(int button, int action) {
+	// Presses that land on a GUI window belong to ImGui, releases always go
+	// through so a drag that ends over the GUI still finishes
+	bool down = action == GLFW_PRESS;
+	if (down && ImGui::GetCurrentContext() && ImGui::GetIO().WantCaptureMouse) return;
+	double x, y;
+	glfwGetCursorPos(window, &x, &y);
+	pointers.button(button, down, (float)(x * renderWidth / windowWidth), (float)(y * renderHeight / windowHeight));
+}
+
+void TvgWindow::drawCanvas() {
+	rasterRequested = true;
+}
+
+void TvgWindow::startRenderThread() {
+	renderStopping = false;
+	renderThread = std::thread(&TvgWindow::renderLoop, this);
+}
+
+void TvgWindow::stopRenderThread() {
+	if (!renderThread.joinable()) return;
+	{
+		std::lock_guard<std::mutex> lock(renderMutex);
+		renderStopping = true;
+	}
+	renderSignal.notify_all();
+	renderThread.join();
+}
+
+void TvgWindow::renderLoop() {
+	std::unique_lock<std::mutex> lock(renderMutex);
+	while (true) {
+		renderSignal.wait(lock, [this] { return rasterPending || renderStopping; });
+		if (renderStopping) return;
+
+		// The main thread doesn't touch the canvas or buffer while a raster
+		// is pending, so the lock isn't needed for the draw itself
+		lock.unlock();
+		auto start = std::chrono::steady_clock::now();
+		taskSystem->raster(canvas.get());
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		lock.lock();
+
+		rasterTime = ms;
+		rasterPending = false;
+		renderSignal.notify_all();
+		// Wake the main thread in case it is waiting for events
+		if (onDemand) glfwPostEmptyEvent();
+	}
+}
+
+void TvgWindow::submitRaster() {
+	if (!rasterRequested) return;
+	rasterRequested = false;
+	{
+		std::lock_guard<std::mutex> lock(renderMutex);
+		rasterPending = true;
+	}
+	rasterInFlight = true;
+	renderSignal.notify_all();
+}
+
+void TvgWindow::collectRaster() {
+	profiler.add(TvgProfiler::Raster, rasterTime);
+	rasterSamples++;
+	rasterAverage = rasterSamples == 1 ? rasterTime : rasterAverage * 0.9f + rasterTime * 0.1f;
+	rasterInFlight = false;
+	if (decoupledRaster) framebuffer.swap();
+	bufferChanged = true;
+}
+
+bool TvgWindow::rasterFinished() {
+	if (!rasterInFlight) return true;
+	{
+		std::lock_guard<std::mutex> lock(renderMutex);
+		if (rasterPending) return false;
+	}
+	collectRaster();
+	return true;
+}
+
+void TvgWindow::waitRaster() {
+	if (!rasterInFlight) return;
+	{
+		std::unique_lock<std::mutex> lock(renderMutex);
+		renderSignal.wait(lock, [this] { return !rasterPending; });
+	}
+	collectRaster();
+}
+
 void TvgWindow::onResize(int w, int h) {
-	// Create a new framebuffer
+	glfwMakeContextCurrent(window);
 	width = w;
 	height = h;
-	delete[] buffer;
-	buffer = new uint32_t[width * height];
-
-	// Create a new texture
-	glDeleteTextures(1, &texture);
-	glGenTextures(1, &texture);
-	glBindTexture(GL_TEXTURE_2D, texture);
-	glTexImage2D(
-		GL_TEXTURE_2D,
-		0,
-		GL_RGBA,
-		width, height,
-		0,
-		GL_RGBA,
-		GL_UNSIGNED_BYTE,
-		(void*)buffer
-	);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-	// reattach buffer to tvg canvas
-	canvas->target(buffer, width, width, height, tvg::SwCanvas::ABGR8888);
-
-	// Set projection
+	glfwGetWindowSize(window, &windowWidth, &windowHeight);
+	windowWidth = std::max(1, windowWidth);
+	windowHeight = std::max(1, windowHeight);
+	resizeTime = glfwGetTime();
+	allocateRenderBuffers(true);
+	updateContentScale();
+	requestRedraw();
+
+	// Set projection. The quad always covers the window, whatever the
+	// resolution of the texture on it.
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	glOrtho(0.0f, width, height, 0.0f, 0.0f, 1.0f);
 	glViewport(0, 0, width, height);
 }
 
+void TvgWindow::allocateRenderBuffers(bool deferrable) {
+	int w = std::max(1, (int)(width * renderScale + 0.5f));
+	int h = std::max(1, (int)(height * renderScale + 0.5f));
+	resizePending = false;
+	if (w == renderWidth && h == renderHeight && framebuffer.front()) return;
+
+	// While the window is being dragged to a size the framebuffer can't
+	// hold, wait for it to settle rather than reallocating on every step
+	if (deferrable && framebuffer.front() && !framebuffer.fits(w, h)) {
+		resizePending = true;
+		return;
+	}
+
+	// Let a frame in flight finish before its buffers change
+	waitRaster();
+	// Resizing within the storage keeps the last frame's pixels, which can
+	// be presented while the next one rasterizes
+	if (framebuffer.resize(w, h)) buffersReallocated = true;
+	renderWidth = w;
+	renderHeight = h;
+
+	// reattach buffer to tvg canvas
+	canvas->target(framebuffer.front(), framebuffer.stride, renderWidth, renderHeight, tvg::SwCanvas::ABGR8888);
+}
+
+void TvgWindow::onContentScale(float scale) {
+	contentScale = scale;
+	updateContentScale();
+	requestRedraw();
+}
+
+void TvgWindow::updateContentScale() {
+	if (!imgui) return;
+	// Where the framebuffer is larger than the window ImGui already draws at
+	// the higher density, what is left is any scale the system wants on top
+	float scale = contentScale * windowWidth / std::max(1, width);
+	ImGui::SetCurrentContext(imgui);
+	ImGuiStyle style;
+	ImGui::StyleColorsDark(&style);
+	style.ScaleAllSizes(scale);
+	ImGui::GetStyle() = style;
+	ImGui::GetIO().FontGlobalScale = scale;
+}
+
+void TvgWindow::adjustResolution() {
+	if (!dynamicResolution || rasterSamples < resolutionSettleFrames) return;
+
+	// Raster cost grows with the pixel count, the square of the scale. Scale
+	// down as soon as the average is over budget for a while, back up only
+	// when the larger size is predicted to fit with room to spare.
+	float budget = (float)(targetFrameTime * 1000.0 * rasterBudget);
+	float scale = renderScale;
+	if (rasterAverage > budget) {
+		scale = std::min(renderScale - resolutionStep, renderScale * std::sqrt(budget / rasterAverage));
+	}
+	else {
+		float up = renderScale + resolutionStep;
+		float predicted = rasterAverage * (up * up) / (renderScale * renderScale);
+		if (predicted < budget * 0.75f) scale = up;
+	}
+	scale = std::max(minRenderScale, std::min(maxRenderScale, scale));
+	// Snap to whole steps so small wobbles never reallocate
+	scale = std::round(scale / resolutionStep) * resolutionStep;
+	scale = std::max(minRenderScale, std::min(maxRenderScale, scale));
+	if (std::fabs(scale - renderScale) < resolutionStep * 0.5f) return;
+
+	renderScale = scale;
+	allocateRenderBuffers();
+	rasterSamples = 0;
+}
+
 bool TvgWindow::run() {
+	return runAll({ this });
+}
+
+bool TvgWindow::begin() {
 	// Exit if there was an error during setup
-	if (!TvgWindow::instance) return false;
+	if (!window) return false;
+	glfwMakeContextCurrent(window);
 
-	// Set up Dear ImGui
+	// Set up Dear ImGui. Each window has its own context, GLFW events are
+	// forwarded to it by our callbacks.
 	IMGUI_CHECKVERSION();
-	ImGui::CreateContext();
-	ImGuiIO& io = ImGui::GetIO(); (void)io;
-	ImGui::StyleColorsDark();
-	ImGui_ImplGlfw_InitForOpenGL(window, true);
+	imgui = ImGui::CreateContext();
+	ImGui::SetCurrentContext(imgui);
+	updateContentScale();
+	ImGui_ImplGlfw_InitForOpenGL(window, false);
 	ImGui_ImplOpenGL3_Init(glsl_version.c_str());
 
 	// User setup
 	setup();
 
-	// Main render loop
-	while (!glfwWindowShouldClose(window))
-	{
-		// Clear
-		glClearColor(((clearColor >> 16) & 0xff) / 255.0f, ((clearColor >> 8) & 0xff) / 255.0f, (clearColor & 0xff) / 255.0f, ((clearColor >> 24) & 0xff) / 255.0f);
-		glClear(GL_COLOR_BUFFER_BIT);
+	startRenderThread();
+	return true;
+}
 
-		// User render loop
-		double thisTime = glfwGetTime();
-		fps = 1.0 / (thisTime - lastTime);
-		update(thisTime - lastTime);
-
-		// Render the buffer to a texture and display it
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexSubImage2D(
-			GL_TEXTURE_2D,
-			0,
-			0, 0,
-			width, height,
-			GL_RGBA,
-			GL_UNSIGNED_BYTE,
-			(void*)buffer
-		);
-		glBegin(GL_QUADS); 
-		glTexCoord2f(0, 0); glVertex2f(0, 0);
-		glTexCoord2f(1, 0); glVertex2f(width, 0);
-		glTexCoord2f(1, 1); glVertex2f(width, height);
-		glTexCoord2f(0, 1); glVertex2f(0, height);
-		glEnd();
-		glBindTexture(GL_TEXTURE_2D, 0);
-
-		// Start the Dear ImGui frame
-		ImGui_ImplOpenGL3_NewFrame();
-		ImGui_ImplGlfw_NewFrame();
-		ImGui::NewFrame();
-
-		// User render GUI loop
-		updateGui(thisTime - lastTime);
-
-		// Render ImGui
-		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
-
-		// Swap framebuffers
-		glfwSwapBuffers(window);
-		glfwPollEvents();
+void TvgWindow::requestRedraw(int frames) {
+	int current = redrawFrames.load();
+	while (current < frames) {
+		if (redrawFrames.compare_exchange_weak(current, frames)) {
+			// The main loop may be blocked waiting for events
+			if (onDemand) glfwPostEmptyEvent();
+			break;
+		}
+	}
+}
+
+bool TvgWindow::wantsFrame() {
+	return !onDemand || redrawFrames > 0 || rasterInFlight || resizePending || animating();
+}
+
+void TvgWindow::beginFrame(double thisTime) {
+	profiler.beginFrame();
+	int frames = redrawFrames.load();
+	while (frames > 0 && !redrawFrames.compare_exchange_weak(frames, frames - 1)) {}
+
+	// After idling, time starts again from now rather than jumping ahead
+	if (idle) {
 		lastTime = thisTime;
+		lastUpdateTime = thisTime;
+		idle = false;
+	}
+
+	if (decoupledRaster) {
+		// While a frame is still rasterizing the canvas is busy. The window
+		// presents the last finished frame again and updates next loop.
+		if (!rasterFinished()) return;
+	}
+	if (resizePending && thisTime - resizeTime >= resizeDelay) allocateRenderBuffers();
+	adjustResolution();
+
+	// User render loop
+	fps = 1.0 / (thisTime - lastUpdateTime);
+	ImGui::SetCurrentContext(imgui);
+	profiler.begin(TvgProfiler::Update);
+	update(thisTime - lastUpdateTime);
+	profiler.end(TvgProfiler::Update);
+	lastUpdateTime = thisTime;
+
+	if (decoupledRaster && rasterRequested) {
+		canvas->target(framebuffer.back(), framebuffer.stride, renderWidth, renderHeight, tvg::SwCanvas::ABGR8888);
+	}
+	submitRaster();
+
+	// New buffers hold nothing yet. Rather than presenting that, the first
+	// frame after a reallocation is waited for even when decoupled.
+	if (buffersReallocated) {
+		waitRaster();
+		buffersReallocated = false;
+	}
+}
 
-		// User closed window?
-		if (shouldClose) glfwSetWindowShouldClose(window, GLFW_TRUE);
+void TvgWindow::endFrame(double thisTime, bool vsync) {
+	if (!decoupledRaster) waitRaster();
+	glfwMakeContextCurrent(window);
+	if (swapInterval != (vsync ? 1 : 0)) {
+		swapInterval = vsync ? 1 : 0;
+		glfwSwapInterval(swapInterval);
+	}
+	ImGui::SetCurrentContext(imgui);
+
+	// Clear
+	glClearColor(((clearColor >> 16) & 0xff) / 255.0f, ((clearColor >> 8) & 0xff) / 255.0f, (clearColor & 0xff) / 255.0f, ((clearColor >> 24) & 0xff) / 255.0f);
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	// Render the buffer to a texture and display it
+	profiler.begin(TvgProfiler::Upload);
+	if (bufferChanged) {
+		framebuffer.upload();
+		bufferChanged = false;
 	}
+	framebuffer.draw(width, height);
+	profiler.end(TvgProfiler::Upload);
+
+	// Start the Dear ImGui frame
+	ImGui_ImplOpenGL3_NewFrame();
+	ImGui_ImplGlfw_NewFrame();
+	ImGui::NewFrame();
+
+	// User render GUI loop
+	profiler.begin(TvgProfiler::Gui);
+	updateGui(thisTime - lastTime);
+	if (ImGui::IsKeyPressed(ImGuiKey_F1)) showProfiler = !showProfiler;
+	if (showProfiler) profiler.draw(&showProfiler);
+	profiler.end(TvgProfiler::Gui);
+
+	// Render ImGui
+	profiler.begin(TvgProfiler::ImGuiRender);
+	ImGui::Render();
+	ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+	profiler.end(TvgProfiler::ImGuiRender);
+
+	// Swap framebuffers
+	profiler.begin(TvgProfiler::Swap);
+	glfwSwapBuffers(window);
+	profiler.end(TvgProfiler::Swap);
+	lastTime = thisTime;
+
+	// User closed window?
+	if (shouldClose) glfwSetWindowShouldClose(window, GLFW_TRUE);
+}
+
+void TvgWindow::end() {
+	waitRaster();
+	stopRenderThread();
+	glfwMakeContextCurrent(window);
+	ImGui::SetCurrentContext(imgui);
 
 	// User cleanup
 	cleanup();
@@ -193,7 +513,56 @@ bool TvgWindow::run() {
 	// Clean up Dear ImGui
 	ImGui_ImplOpenGL3_Shutdown();
 	ImGui_ImplGlfw_Shutdown();
-	ImGui::DestroyContext();
+	ImGui::DestroyContext(imgui);
+	imgui = nullptr;
+	framebuffer.releaseTexture();
 
-	return true;
+	glfwHideWindow(window);
+}
+
+bool TvgWindow::runAll(const std::vector<TvgWindow*>& windows) {
+	std::vector<TvgWindow*> open;
+	bool ok = true;
+	for (auto w : windows) {
+		if (w->begin()) open.push_back(w);
+		else ok = false;
+	}
+
+	// Main render loop. All windows build their scenes first, so their render
+	// threads rasterize in parallel while the rest are still updating.
+	std::vector<TvgWindow*> drawing;
+	while (!open.empty()) {
+		double thisTime = glfwGetTime();
+		drawing.clear();
+		double timeout = -1;
+		for (auto w : open) {
+			if (w->wantsFrame()) drawing.push_back(w);
+			else {
+				w->idle = true;
+				timeout = timeout < 0 ? w->idleTimeout : std::min(timeout, w->idleTimeout);
+			}
+		}
+
+		// Only the first window drawn waits for vsync, otherwise every swap
+		// would wait for its own interval and the frame rate would drop with
+		// each window
+		for (auto w : drawing) w->beginFrame(thisTime);
+		for (size_t i = 0; i < drawing.size(); i++) drawing[i]->endFrame(thisTime, i == 0);
+
+		// Handlers that change the scene or its buffers must wait for the
+		// window's raster first, see waitRaster(). When every window is idle
+		// block until something happens.
+		if (drawing.empty() && timeout > 0) glfwWaitEventsTimeout(timeout);
+		else glfwPollEvents();
+
+		for (size_t i = 0; i < open.size();) {
+			if (glfwWindowShouldClose(open[i]->window)) {
+				open[i]->end();
+				open.erase(open.begin() + i);
+			}
+			else i++;
+		}
+	}
+
+	return ok;
 }
@@ -1,6 +1,9 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdlib>
+#include <mutex>
 #include <thread>
 #include <vector>
 #include <iostream>
@@ -14,21 +17,117 @@
 
 #include "thorvg.h"
 
+#include "../common/TaskSystem.h"
+#include "TvgFramebuffer.h"
+#include "TvgProfiler.h"
+#include "PointerQueue.h"
+
 class TvgWindow {
 protected:
 	std::string glsl_version;
 	GLFWwindow* window = nullptr;
-	uint32_t* buffer = nullptr;
-	GLuint texture = 0;
+	TvgFramebuffer framebuffer;
+	// The window size in framebuffer pixels
 	int width = 0;
 	int height = 0;
+	// The window size in screen coordinates, which cursor positions are in.
+	// Smaller than width and height where the system scales windows.
+	int windowWidth = 0;
+	int windowHeight = 0;
+	// The system's UI scale for the monitor the window is on
+	float contentScale = 1.0f;
+	// The size of the buffer the canvas draws into, width and height scaled
+	// by renderScale. Build the scene for this size, pointers are reported in it.
+	int renderWidth = 0;
+	int renderHeight = 0;
+	float renderScale = 1.0f;
+	// A resize the framebuffer can't take without reallocating waits until
+	// the window size has been still for resizeDelay seconds, the last frame
+	// is stretched over the window meanwhile
+	double resizeDelay = 0.15;
+	double resizeTime = 0;
+	bool resizePending = false;
 	std::unique_ptr<tvg::SwCanvas> canvas = nullptr;
 	double lastTime = 0;
+	double lastUpdateTime = 0;
 	double fps = 0;
 	bool shouldClose = false;
 	uint32_t clearColor = 0xff000000; // ARGB
+	TvgProfiler profiler;
+	bool showProfiler = false;
+	PointerQueue pointers;
+	ImGuiContext* imgui = nullptr;
+
+	// Rasterization runs on the window's own thread. The main thread hands it
+	// a frame after update and waits for it before touching the buffer again.
+	std::thread renderThread;
+	std::mutex renderMutex;
+	std::condition_variable renderSignal;
+	bool rasterRequested = false;
+	bool rasterPending = false;
+	bool renderStopping = false;
+	float rasterTime = 0;
+	// Main thread only: a raster was submitted and not yet collected
+	bool rasterInFlight = false;
+
+	// With decoupled rasterization the render thread draws into the back
+	// buffer while the main thread presents the front one, and the two swap
+	// when a frame completes. Set it in the constructor or setup.
+	bool decoupledRaster = false;
+	bool bufferChanged = true;
+
+	void startRenderThread();
+	void stopRenderThread();
+	void renderLoop();
+	void submitRaster();
+	void collectRaster();
+	bool rasterFinished();
+
+	// On demand windows only draw when animating() or after a redraw request,
+	// and the main loop blocks for up to idleTimeout seconds while every window
+	// is idle. Set them in the constructor or setup.
+	bool onDemand = false;
+	double idleTimeout = 0.5;
+	std::atomic<int> redrawFrames{ 1 };
+	bool idle = false;
+	int swapInterval = -1;
+
+	// With dynamic resolution the render scale follows the measured raster
+	// time, keeping it within rasterBudget of targetFrameTime. Set them in the
+	// constructor or setup.
+	bool dynamicResolution = false;
+	double targetFrameTime = 1.0 / 60.0;
+	double rasterBudget = 0.8;
+	float minRenderScale = 0.5f;
+	float maxRenderScale = 1.0f;
+	float resolutionStep = 0.05f;
+	int resolutionSettleFrames = 30;
+	float rasterAverage = 0;
+	int rasterSamples = 0;
+	bool buffersReallocated = false;
+
+	void allocateRenderBuffers(bool deferrable = false);
+	void adjustResolution();
+	void updateContentScale();
+
+	bool begin();
+	bool wantsFrame();
+	void beginFrame(double time);
+	void endFrame(double time, bool vsync);
+	void end();
 public:
-	static TvgWindow* instance;
+	/**
+	 * The thread budget shared by ThorVG and any task system workers. Set
+	 * before the first window is created. ThorVG gets all of it by default,
+	 * set rasterThreads to leave workers for tasks().
+	 */
+	static TaskSystem::Options taskOptions;
+
+	/**
+	 * The task system windows rasterize with, for submitting application
+	 * work to its workers. Only valid while a window exists.
+	 */
+	static TaskSystem& tasks();
 
 	/**
 	 * Create a new window
@@ -55,13 +154,21 @@ public:
 	 */
 	bool run();
 
+	/**
+	 * Run several windows together on the calling thread, each rasterizing
+	 * on its own render thread. Returns once every window has closed.
+	 * @return false if any of the windows failed to open
+	 */
+	static bool runAll(const std::vector<TvgWindow*>& windows);
+
 	/**
 	 * Override this to perform one-time setup actions
 	 */
 	virtual void setup() {}
 
 	/**
-	 * Override this to render thorVG on every loop.
+	 * Override this to build the thorVG scene on every loop. Rasterization
+	 * happens after update returns, on the window's render thread.
 	 * @param dt The number of seconds since the last call to update
 	 */
 	virtual void update(double dt) {}
@@ -72,6 +179,33 @@ public:
 	 */
 	virtual void updateGui(double dt) {}
 
+	/**
+	 * Ask for the canvas to be rasterized into the buffer once update
+	 * returns. Without it the buffer keeps showing the previous frame.
+	 */
+	void drawCanvas();
+
+	/**
+	 * Override this to report whether the content is still changing. On
+	 * demand windows keep drawing while it returns true.
+	 */
+	virtual bool animating() { return false; }
+
+	/**
+	 * Draw the next frames of an on demand window. Input, resizes and exposes
+	 * request them already. Safe to call from any thread, an idle main loop
+	 * is woken up.
+	 * @param frames The number of frames to draw. ImGui needs a couple to
+	 * settle after input.
+	 */
+	void requestRedraw(int frames = 2);
+
+	/**
+	 * Block until the frame being rasterized, if any, is finished. Call
+	 * before changing anything the canvas refers to outside of update.
+	 */
+	void waitRaster();
+
 	/**
 	 * Override this to perform one-time cleanup actions
 	 */
@@ -82,5 +216,11 @@ public:
 	 * If you override these, make sure to call the inherited method
 	 **/
 	void onResize(int w, int h);
+	void onContentScale(float scale);
+	void onCursorPos(double x, double y);
+	void onMouseButton(int button, int action);
+
+	GLFWwindow* glfwWindow() const { return window; }
+	ImGuiContext* imguiContext() const { return imgui; }
 	virtual void onFilesDropped(std::vector<std::string> paths) {}
 };